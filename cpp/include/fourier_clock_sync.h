@@ -0,0 +1,182 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+// Parses the feedback age reported by cxx_get_motor_state, which uses Rust's
+// Duration debug format ("193.624µs", "1.2ms", "3s", "850ns").
+inline bool parse_motor_age(const std::string &text, double &seconds)
+{
+    const char *begin = text.c_str();
+    char *end = nullptr;
+    double value = std::strtod(begin, &end);
+    if (end == begin)
+        return false;
+    std::string unit(end);
+    if (unit == "s")
+        seconds = value;
+    else if (unit == "ms")
+        seconds = value * 1e-3;
+    else if (unit == "\xC2\xB5s" || unit == "us")
+        seconds = value * 1e-6;
+    else if (unit == "ns")
+        seconds = value * 1e-9;
+    else
+        return false;
+    return true;
+}
+
+// Maps one motor's feedback stream onto the host monotonic clock. Each poll
+// yields an arrival estimate (host read time minus reported age); arrivals of
+// distinct frames are numbered by the motor's own send period and a least
+// squares line t = offset + period * n is fitted over a sliding window. The
+// line removes poll-time quantisation and clock drift; its residual is the
+// jitter, and the prediction error of the fit is the per-sample uncertainty.
+class MotorClockSync
+{
+public:
+    explicit MotorClockSync(size_t window = 64)
+        : frames(window < 4 ? 4 : window), arrivals(window < 4 ? 4 : window) {}
+
+    // Returns true if (read_time, age) belongs to a frame not seen before.
+    bool observe(double read_time, double age)
+    {
+        double arrival = read_time - age;
+        double same_frame = period > 0.0 ? 0.25 * period : min_separation;
+        if (count > 0 && std::fabs(arrival - last_arrival) < same_frame)
+            return false;
+
+        int64_t frame = 0;
+        if (count > 0)
+        {
+            double diff = arrival - last_arrival;
+            if (diff <= 0.0)
+                return false;
+            // A gap shorter than the assumed cadence means frames were numbered
+            // too coarsely (polling slower than the motor sends); start over.
+            double unit = period > 0.0 ? period : min_diff;
+            if (unit > 0.0 && diff < 0.75 * unit)
+            {
+                count = 0;
+                next = 0;
+                period = 0.0;
+            }
+            if (min_diff <= 0.0 || diff < min_diff)
+                min_diff = diff;
+            if (count > 0)
+            {
+                unit = period > 0.0 ? period : min_diff;
+                int64_t step = int64_t(std::llround(diff / unit));
+                frame = last_frame + (step < 1 ? 1 : step);
+            }
+        }
+        last_frame = frame;
+        last_arrival = arrival;
+
+        frames[next] = frame;
+        arrivals[next] = arrival;
+        next = (next + 1) % frames.size();
+        if (count < frames.size())
+            ++count;
+        fit();
+        return true;
+    }
+
+    bool synchronized() const
+    {
+        return count >= min_samples && period > 0.0;
+    }
+
+    // Host monotonic time of the newest frame and its 1-sigma uncertainty.
+    double timestamp() const
+    {
+        return synchronized() ? offset + period * double(last_frame - base_frame) : last_arrival;
+    }
+
+    double uncertainty() const
+    {
+        if (!synchronized())
+            return jitter_rms > 0.0 ? jitter_rms : 0.0;
+        double dn = double(last_frame - base_frame) - mean_frame;
+        return jitter_rms * std::sqrt(1.0 / double(count) + dn * dn / frame_spread);
+    }
+
+    double jitter() const
+    {
+        return jitter_rms;
+    }
+
+    double frame_period() const
+    {
+        return period;
+    }
+
+private:
+    void fit()
+    {
+        if (count < min_samples)
+            return;
+        // Work relative to the oldest frame in the window to keep precision.
+        size_t oldest = (next + frames.size() - count) % frames.size();
+        base_frame = frames[oldest];
+        double base_time = arrivals[oldest];
+
+        double sum_n = 0.0, sum_t = 0.0;
+        for (size_t i = 0; i < count; ++i)
+        {
+            size_t k = (oldest + i) % frames.size();
+            sum_n += double(frames[k] - base_frame);
+            sum_t += arrivals[k] - base_time;
+        }
+        double n_mean = sum_n / double(count);
+        double t_mean = sum_t / double(count);
+        double sxx = 0.0, sxy = 0.0;
+        for (size_t i = 0; i < count; ++i)
+        {
+            size_t k = (oldest + i) % frames.size();
+            double dn = double(frames[k] - base_frame) - n_mean;
+            sxx += dn * dn;
+            sxy += dn * (arrivals[k] - base_time - t_mean);
+        }
+        if (sxx <= 0.0)
+            return;
+        double slope = sxy / sxx;
+        if (slope <= 0.0)
+            return;
+        double intercept = t_mean - slope * n_mean;
+
+        double sse = 0.0;
+        for (size_t i = 0; i < count; ++i)
+        {
+            size_t k = (oldest + i) % frames.size();
+            double residual = arrivals[k] - base_time - (intercept + slope * double(frames[k] - base_frame));
+            sse += residual * residual;
+        }
+        period = slope;
+        offset = base_time + intercept;
+        mean_frame = n_mean;
+        frame_spread = sxx;
+        jitter_rms = std::sqrt(sse / double(count - 2));
+    }
+
+    static constexpr size_t min_samples = 8;
+    static constexpr double min_separation = 100e-6;
+
+    std::vector<int64_t> frames;
+    std::vector<double> arrivals;
+    size_t next = 0;
+    size_t count = 0;
+    int64_t last_frame = 0;
+    double last_arrival = 0.0;
+    double min_diff = 0.0;
+
+    int64_t base_frame = 0;
+    double offset = 0.0;
+    double period = 0.0;
+    double mean_frame = 0.0;
+    double frame_spread = 1.0;
+    double jitter_rms = 0.0;
+};
@@ -0,0 +1,234 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+// Pool of I/O threads shared by several managers. Each registered task is a
+// periodic tick pinned to one pool thread (the one with the fewest tasks at
+// registration); a thread sleeps until the earliest deadline of its tasks and
+// runs every task that is due. Tasks on one thread run one after another, so a
+// slow tick delays its neighbours, never itself overlaps.
+//
+// Threads are optionally pinned to `cpus` (round robin). The executor must
+// outlive every task registered with it.
+class FourierIoExecutor
+{
+public:
+    // Called with how late (seconds) the thread woke up for this tick.
+    using Task = std::function<void(double lateness)>;
+
+    explicit FourierIoExecutor(size_t threads, std::vector<int> cpus = {})
+    {
+        if (threads == 0)
+            threads = 1;
+        for (size_t i = 0; i < threads; ++i)
+            workers.emplace_back(new Worker);
+        for (size_t i = 0; i < threads; ++i)
+        {
+            Worker &worker = *workers[i];
+            worker.thread = std::thread([this, &worker]
+                                        { run(worker); });
+            if (!cpus.empty())
+                worker.pinned = pin(worker.thread, cpus[i % cpus.size()]);
+        }
+    }
+
+    ~FourierIoExecutor()
+    {
+        for (auto &worker : workers)
+        {
+            {
+                std::lock_guard<std::mutex> lock(worker->mutex);
+                worker->stopping = true;
+            }
+            worker->changed.notify_all();
+        }
+        for (auto &worker : workers)
+            worker->thread.join();
+    }
+
+    FourierIoExecutor(const FourierIoExecutor &) = delete;
+    FourierIoExecutor &operator=(const FourierIoExecutor &) = delete;
+
+    size_t thread_count() const
+    {
+        return workers.size();
+    }
+
+    size_t pinned_count() const
+    {
+        size_t count = 0;
+        for (const auto &worker : workers)
+            count += worker->pinned ? 1 : 0;
+        return count;
+    }
+
+    // Runs `task` every `period` seconds, first one period from now. Returns
+    // a handle for remove(), or 0 when `period` is not positive.
+    uint64_t add(Task task, double period)
+    {
+        if (period <= 0.0 || !task)
+            return 0;
+        Worker *target = nullptr;
+        uint64_t handle = 0;
+        {
+            std::lock_guard<std::mutex> lock(handles_mutex);
+            handle = ++last_handle;
+            for (auto &worker : workers)
+            {
+                std::lock_guard<std::mutex> worker_lock(worker->mutex);
+                if (!target || worker->tasks.size() < target->tasks.size())
+                    target = worker.get();
+            }
+            owners.push_back({handle, target});
+        }
+
+        std::unique_ptr<Entry> entry(new Entry);
+        entry->handle = handle;
+        entry->task = std::move(task);
+        entry->period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(period));
+        entry->next = Clock::now() + entry->period;
+        {
+            std::lock_guard<std::mutex> lock(target->mutex);
+            target->tasks.push_back(std::move(entry));
+        }
+        target->changed.notify_all();
+        return handle;
+    }
+
+    // Unregisters a task. On return the task is not running and never runs
+    // again. Must not be called from inside a task on the same thread.
+    bool remove(uint64_t handle)
+    {
+        Worker *owner = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(handles_mutex);
+            for (size_t i = 0; i < owners.size(); ++i)
+            {
+                if (owners[i].handle == handle)
+                {
+                    owner = owners[i].worker;
+                    owners[i] = owners.back();
+                    owners.pop_back();
+                    break;
+                }
+            }
+        }
+        if (!owner)
+            return false;
+
+        std::unique_lock<std::mutex> lock(owner->mutex);
+        owner->changed.wait(lock, [owner, handle]
+                            { return owner->running != handle; });
+        for (size_t i = 0; i < owner->tasks.size(); ++i)
+        {
+            if (owner->tasks[i]->handle == handle)
+            {
+                owner->tasks.erase(owner->tasks.begin() + i);
+                break;
+            }
+        }
+        lock.unlock();
+        owner->changed.notify_all();
+        return true;
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Entry
+    {
+        uint64_t handle = 0;
+        Task task;
+        Clock::duration period{};
+        Clock::time_point next{};
+    };
+
+    struct Worker
+    {
+        std::mutex mutex;
+        std::condition_variable changed;
+        std::vector<std::unique_ptr<Entry>> tasks;
+        uint64_t running = 0;
+        bool stopping = false;
+        bool pinned = false;
+        std::thread thread;
+    };
+
+    struct Owner
+    {
+        uint64_t handle;
+        Worker *worker;
+    };
+
+    static bool pin(std::thread &thread, int cpu)
+    {
+#ifdef __linux__
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        return pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set) == 0;
+#else
+        (void)thread;
+        (void)cpu;
+        return false;
+#endif
+    }
+
+    void run(Worker &worker)
+    {
+        std::unique_lock<std::mutex> lock(worker.mutex);
+        while (!worker.stopping)
+        {
+            if (worker.tasks.empty())
+            {
+                worker.changed.wait(lock);
+                continue;
+            }
+
+            size_t due = 0;
+            for (size_t i = 1; i < worker.tasks.size(); ++i)
+            {
+                if (worker.tasks[i]->next < worker.tasks[due]->next)
+                    due = i;
+            }
+            Clock::time_point deadline = worker.tasks[due]->next;
+            if (Clock::now() < deadline)
+            {
+                // Woken early by add/remove/stop: pick the earliest task again.
+                worker.changed.wait_until(lock, deadline);
+                continue;
+            }
+
+            // remove() waits for `running`, so the entry stays alive unlocked.
+            Entry *entry = worker.tasks[due].get();
+            Clock::time_point now = Clock::now();
+            double lateness = std::chrono::duration<double>(now - deadline).count();
+            entry->next += entry->period;
+            if (entry->next < now)
+                entry->next = now;
+            worker.running = entry->handle;
+            lock.unlock();
+            entry->task(lateness);
+            lock.lock();
+            worker.running = 0;
+            worker.changed.notify_all();
+        }
+    }
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::mutex handles_mutex;
+    std::vector<Owner> owners;
+    uint64_t last_handle = 0;
+};
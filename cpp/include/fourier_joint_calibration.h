@@ -0,0 +1,208 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Marks an element-wise loop whose input and output arrays are either the
+// same or disjoint, so the vectorizer needs no runtime overlap check. The
+// loop is still only vectorized with -O3 (or -O2 -ftree-vectorize); CMake
+// builds default to Release for that reason.
+#if defined(__clang__)
+#define FOURIER_VECTOR_LOOP _Pragma("clang loop vectorize(assume_safety)")
+#elif defined(__GNUC__)
+#define FOURIER_VECTOR_LOOP _Pragma("GCC ivdep")
+#else
+#define FOURIER_VECTOR_LOOP
+#endif
+
+// Mounting of one motor on its joint:
+//   joint position = sign * (motor position - offset) / gear_ratio
+// Offset is in motor radians, sign is +1 or -1. Velocity scales like position
+// without the offset; torque scales the other way (times the gear ratio).
+struct JointCalibrationEntry
+{
+    int32_t id = 0;
+    float offset = 0.0f;
+    float sign = 1.0f;
+    float gear_ratio = 1.0f;
+};
+
+// Joint-space limits of one motor: position range, and the largest velocity
+// and effort magnitude it may be commanded.
+struct JointLimitEntry
+{
+    int32_t id = 0;
+    float position_min = 0.0f;
+    float position_max = 0.0f;
+    float max_velocity = 0.0f;
+    float max_effort = 0.0f;
+};
+
+// Calibration table persisted next to the topology cache, one line per motor:
+//   joint <id> <offset> <sign> <gear_ratio>
+//   limit <id> <position_min> <position_max> <max_velocity> <max_effort>
+// Motors without a joint line are identity, without a limit line unlimited.
+struct JointCalibration
+{
+    std::vector<JointCalibrationEntry> joints;
+    std::vector<JointLimitEntry> limits;
+
+    bool save(const std::string &path) const
+    {
+        std::string temporary = path + ".tmp";
+        {
+            std::ofstream out(temporary, std::ios::trunc);
+            if (!out)
+                return false;
+            out.precision(9);
+            for (const auto &joint : joints)
+                out << "joint " << joint.id << ' ' << joint.offset << ' ' << joint.sign << ' ' << joint.gear_ratio << '\n';
+            for (const auto &limit : limits)
+                out << "limit " << limit.id << ' ' << limit.position_min << ' ' << limit.position_max << ' '
+                    << limit.max_velocity << ' ' << limit.max_effort << '\n';
+            if (!out)
+                return false;
+        }
+        return std::rename(temporary.c_str(), path.c_str()) == 0;
+    }
+
+    bool load(const std::string &path)
+    {
+        std::ifstream in(path);
+        if (!in)
+            return false;
+        std::vector<JointCalibrationEntry> loaded;
+        std::vector<JointLimitEntry> loaded_limits;
+        std::string line;
+        while (std::getline(in, line))
+        {
+            if (line.empty())
+                continue;
+            std::istringstream fields(line);
+            std::string tag;
+            if (!(fields >> tag))
+                return false;
+            if (tag == "limit")
+            {
+                JointLimitEntry limit;
+                if (!(fields >> limit.id >> limit.position_min >> limit.position_max >> limit.max_velocity >> limit.max_effort) ||
+                    limit.position_min > limit.position_max || limit.max_velocity < 0.0f || limit.max_effort < 0.0f)
+                    return false;
+                loaded_limits.push_back(limit);
+                continue;
+            }
+            JointCalibrationEntry joint;
+            if (tag != "joint" || !(fields >> joint.id >> joint.offset >> joint.sign >> joint.gear_ratio) ||
+                (joint.sign != 1.0f && joint.sign != -1.0f) || joint.gear_ratio <= 0.0f)
+                return false;
+            loaded.push_back(joint);
+        }
+        joints.swap(loaded);
+        limits.swap(loaded_limits);
+        return true;
+    }
+};
+
+// Joint-space values of a manager's motors as structure of arrays, in the
+// order of the manager's ids().
+struct JointBuffer
+{
+    std::vector<float> position;
+    std::vector<float> velocity;
+    std::vector<float> effort;
+    std::vector<uint8_t> valid;
+
+    void resize(size_t count)
+    {
+        position.resize(count);
+        velocity.resize(count);
+        effort.resize(count);
+        valid.resize(count);
+    }
+};
+
+// A JointCalibration resolved against a fixed id order. Every conversion is
+// one multiply(-add) per element over contiguous arrays with no branches, so
+// the compiler can vectorize it (see FOURIER_VECTOR_LOOP).
+class JointTransform
+{
+public:
+    JointTransform() = default;
+
+    JointTransform(const JointCalibration &calibration, const std::vector<int32_t> &ids)
+        : offset(ids.size(), 0.0f), to_joint(ids.size(), 1.0f), to_motor(ids.size(), 1.0f)
+    {
+        std::unordered_map<int32_t, size_t> index;
+        for (size_t i = 0; i < ids.size(); ++i)
+            index.emplace(ids[i], i);
+        for (const auto &joint : calibration.joints)
+        {
+            auto it = index.find(joint.id);
+            if (it == index.end())
+                continue;
+            offset[it->second] = joint.offset;
+            to_joint[it->second] = joint.sign / joint.gear_ratio;
+            to_motor[it->second] = joint.sign * joint.gear_ratio;
+        }
+    }
+
+    size_t size() const
+    {
+        return offset.size();
+    }
+
+    // Each conversion covers joints [first, first + count); `in` and `out`
+    // point at the first of them and may be the same array.
+    void position_to_joint(const float *motor, float *joint, size_t first, size_t count) const
+    {
+        const float *o = offset.data() + first, *k = to_joint.data() + first;
+        FOURIER_VECTOR_LOOP
+        for (size_t i = 0; i < count; ++i)
+            joint[i] = (motor[i] - o[i]) * k[i];
+    }
+
+    void position_to_motor(const float *joint, float *motor, size_t first, size_t count) const
+    {
+        const float *o = offset.data() + first, *k = to_motor.data() + first;
+        FOURIER_VECTOR_LOOP
+        for (size_t i = 0; i < count; ++i)
+            motor[i] = joint[i] * k[i] + o[i];
+    }
+
+    void velocity_to_joint(const float *motor, float *joint, size_t first, size_t count) const
+    {
+        scale(motor, joint, to_joint.data() + first, count);
+    }
+
+    void velocity_to_motor(const float *joint, float *motor, size_t first, size_t count) const
+    {
+        scale(joint, motor, to_motor.data() + first, count);
+    }
+
+    void effort_to_joint(const float *motor, float *joint, size_t first, size_t count) const
+    {
+        scale(motor, joint, to_motor.data() + first, count);
+    }
+
+    void effort_to_motor(const float *joint, float *motor, size_t first, size_t count) const
+    {
+        scale(joint, motor, to_joint.data() + first, count);
+    }
+
+private:
+    static void scale(const float *in, float *out, const float *k, size_t count)
+    {
+        FOURIER_VECTOR_LOOP
+        for (size_t i = 0; i < count; ++i)
+            out[i] = in[i] * k[i];
+    }
+
+    std::vector<float> offset;
+    std::vector<float> to_joint;
+    std::vector<float> to_motor;
+};
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+#include "fourier_joint_calibration.h"
+
+enum class LimitKind : uint8_t
+{
+    POSITION,
+    VELOCITY,
+    EFFORT,
+};
+
+// How often each limit of one motor had to clamp a command, and how many
+// non-finite commands were refused.
+struct JointLimitStats
+{
+    uint64_t position = 0;
+    uint64_t velocity = 0;
+    uint64_t effort = 0;
+    uint64_t rejected = 0;
+};
+
+// The limits of a JointCalibration moved into motor space (through the same
+// offsets, signs and gear ratios as the commands) and laid out as lower/upper
+// bound arrays per kind in a fixed id order. Clamping a block is a branch-free
+// max/min plus a counter increment per element, which the compiler can
+// vectorize (see FOURIER_VECTOR_LOOP).
+// NaN and infinite commands are never clamped into range: they are left as
+// they are and counted as rejected, and the caller must drop them. Not
+// thread-safe; the owner locks.
+class JointLimiter
+{
+public:
+    JointLimiter() = default;
+
+    JointLimiter(const JointCalibration &calibration, const JointTransform &transform,
+                 const std::vector<int32_t> &ids)
+    {
+        const float unlimited = std::numeric_limits<float>::infinity();
+        for (auto &bounds : kinds)
+        {
+            bounds.lower.assign(ids.size(), -unlimited);
+            bounds.upper.assign(ids.size(), unlimited);
+            bounds.hits.assign(ids.size(), 0);
+        }
+        rejected.assign(ids.size(), 0);
+        std::unordered_map<int32_t, size_t> index;
+        for (size_t i = 0; i < ids.size(); ++i)
+            index.emplace(ids[i], i);
+        for (const auto &limit : calibration.limits)
+        {
+            auto it = index.find(limit.id);
+            if (it == index.end())
+                continue;
+            size_t i = it->second;
+            float position[2] = {limit.position_min, limit.position_max};
+            transform.position_to_motor(position, position, i, 1);
+            transform.position_to_motor(position + 1, position + 1, i, 1);
+            set(LimitKind::POSITION, i, std::fmin(position[0], position[1]), std::fmax(position[0], position[1]));
+            float velocity = limit.max_velocity, effort = limit.max_effort;
+            transform.velocity_to_motor(&velocity, &velocity, i, 1);
+            transform.effort_to_motor(&effort, &effort, i, 1);
+            set(LimitKind::VELOCITY, i, -std::fabs(velocity), std::fabs(velocity));
+            set(LimitKind::EFFORT, i, -std::fabs(effort), std::fabs(effort));
+            active = true;
+        }
+    }
+
+    bool empty() const
+    {
+        return !active;
+    }
+
+    // Clamps motor-space commands of motors [first, first + count) in place.
+    // Returns how many were non-finite (and left unchanged).
+    size_t clamp(LimitKind kind, float *values, size_t first, size_t count)
+    {
+        Bounds &bounds = kinds[size_t(kind)];
+        const float *lower = bounds.lower.data() + first, *upper = bounds.upper.data() + first;
+        uint64_t *hits = bounds.hits.data() + first;
+        uint64_t *refused = rejected.data() + first;
+        size_t refused_count = 0;
+        FOURIER_VECTOR_LOOP
+        for (size_t i = 0; i < count; ++i)
+        {
+            float value = values[i];
+            // x - x is 0 for finite x and NaN for NaN and infinities.
+            bool finite = value - value == 0.0f;
+            float limited = value > lower[i] ? value : lower[i];
+            limited = limited < upper[i] ? limited : upper[i];
+            limited = finite ? limited : value;
+            hits[i] += finite && limited != value;
+            refused[i] += !finite;
+            refused_count += !finite;
+            values[i] = limited;
+        }
+        return refused_count;
+    }
+
+    // Single command; false if it is non-finite and must be dropped.
+    bool clamp(LimitKind kind, size_t index, float &value)
+    {
+        return clamp(kind, &value, index, 1) == 0;
+    }
+
+    // Counts a non-finite command of a kind without limits (current).
+    void reject(size_t index)
+    {
+        if (index < rejected.size())
+            ++rejected[index];
+    }
+
+    JointLimitStats stats(size_t index) const
+    {
+        JointLimitStats result;
+        if (index >= kinds[0].hits.size())
+            return result;
+        result.position = kinds[size_t(LimitKind::POSITION)].hits[index];
+        result.velocity = kinds[size_t(LimitKind::VELOCITY)].hits[index];
+        result.effort = kinds[size_t(LimitKind::EFFORT)].hits[index];
+        result.rejected = rejected[index];
+        return result;
+    }
+
+private:
+    struct Bounds
+    {
+        std::vector<float> lower;
+        std::vector<float> upper;
+        std::vector<uint64_t> hits;
+    };
+
+    void set(LimitKind kind, size_t index, float lower, float upper)
+    {
+        kinds[size_t(kind)].lower[index] = lower;
+        kinds[size_t(kind)].upper[index] = upper;
+    }
+
+    Bounds kinds[3];
+    std::vector<uint64_t> rejected;
+    bool active = false;
+};
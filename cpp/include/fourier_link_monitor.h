@@ -0,0 +1,128 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <deque>
+
+struct LinkStats
+{
+    uint64_t frames = 0;
+    double rate_hz = 0.0;
+    double interval_mean = 0.0;
+    double jitter = 0.0;
+    double max_gap = 0.0;
+    uint64_t gaps = 0;
+    uint64_t lost = 0;
+    double silence = 0.0;
+};
+
+// Feedback regularity of one motor over a sliding time window. Fed with the
+// arrival time of every new frame; a gap is an interval longer than 1.5x the
+// expected period, and the frames it is estimated to have swallowed count as
+// lost (the bridge exposes no sequence numbers).
+class LinkMonitor
+{
+public:
+    explicit LinkMonitor(double window = 1.0) : window(window) {}
+
+    void observe(double arrival, double expected_period)
+    {
+        if (has_last && arrival > last_arrival)
+        {
+            Interval interval;
+            interval.end = arrival;
+            interval.length = arrival - last_arrival;
+            double period = expected_period > 0.0 ? expected_period : interval_mean();
+            if (period > 0.0 && interval.length > 1.5 * period)
+            {
+                interval.gap = true;
+                interval.lost = uint64_t(std::llround(interval.length / period)) - 1;
+            }
+            add(interval);
+        }
+        if (!has_last)
+            first_arrival = arrival;
+        last_arrival = arrival;
+        has_last = true;
+        expire(arrival);
+    }
+
+    LinkStats stats(double now)
+    {
+        expire(now);
+        LinkStats result;
+        result.frames = intervals.size();
+        // Until a full window has passed, the rate is over the time observed.
+        double span = has_last ? std::fmin(window, now - first_arrival) : 0.0;
+        result.rate_hz = span > 0.0 ? double(intervals.size()) / span : 0.0;
+        result.interval_mean = interval_mean();
+        if (!intervals.empty())
+        {
+            double mean = result.interval_mean;
+            double variance = sum_squares / double(intervals.size()) - mean * mean;
+            result.jitter = variance > 0.0 ? std::sqrt(variance) : 0.0;
+        }
+        for (const auto &interval : intervals)
+        {
+            if (interval.length > result.max_gap)
+                result.max_gap = interval.length;
+        }
+        result.gaps = gap_count;
+        result.lost = lost_count;
+        result.silence = has_last ? now - last_arrival : 0.0;
+        return result;
+    }
+
+private:
+    struct Interval
+    {
+        double end = 0.0;
+        double length = 0.0;
+        bool gap = false;
+        uint64_t lost = 0;
+    };
+
+    double interval_mean() const
+    {
+        return intervals.empty() ? 0.0 : sum / double(intervals.size());
+    }
+
+    void add(const Interval &interval)
+    {
+        intervals.push_back(interval);
+        sum += interval.length;
+        sum_squares += interval.length * interval.length;
+        if (interval.gap)
+            ++gap_count;
+        lost_count += interval.lost;
+    }
+
+    void expire(double now)
+    {
+        while (!intervals.empty() && intervals.front().end < now - window)
+        {
+            const Interval &old = intervals.front();
+            sum -= old.length;
+            sum_squares -= old.length * old.length;
+            if (old.gap)
+                --gap_count;
+            lost_count -= old.lost;
+            intervals.pop_front();
+        }
+        if (intervals.empty())
+        {
+            sum = 0.0;
+            sum_squares = 0.0;
+        }
+    }
+
+    double window;
+    std::deque<Interval> intervals;
+    double sum = 0.0;
+    double sum_squares = 0.0;
+    uint64_t gap_count = 0;
+    uint64_t lost_count = 0;
+    double first_arrival = 0.0;
+    double last_arrival = 0.0;
+    bool has_last = false;
+};
@@ -0,0 +1,455 @@
+#pragma once
+
+#if !defined(__cpp_impl_coroutine)
+#error "fourier_motor_coro.h requires C++20 coroutines"
+#endif
+
+#include <chrono>
+#include <condition_variable>
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "fourier_motor_manager.h"
+
+// Fire-and-forget coroutine started by MotorEventLoop::spawn(). The frame
+// destroys itself when the coroutine finishes.
+class MotorTask
+{
+public:
+    struct promise_type
+    {
+        MotorTask get_return_object()
+        {
+            return MotorTask(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+
+    MotorTask(MotorTask &&other) noexcept : handle(std::exchange(other.handle, {})) {}
+    MotorTask(const MotorTask &) = delete;
+    MotorTask &operator=(const MotorTask &) = delete;
+
+    ~MotorTask()
+    {
+        if (handle)
+            handle.destroy();
+    }
+
+    std::coroutine_handle<> release()
+    {
+        return std::exchange(handle, {});
+    }
+
+private:
+    explicit MotorTask(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+
+    std::coroutine_handle<promise_type> handle;
+};
+
+// Single-threaded executor. Coroutines awaiting motor events are resumed
+// here, on whichever thread calls run() or poll().
+class MotorEventLoop
+{
+public:
+    void post(std::coroutine_handle<> handle)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            ready.push_back(handle);
+        }
+        wakeup.notify_one();
+    }
+
+    void spawn(MotorTask task)
+    {
+        post(task.release());
+    }
+
+    // Resumes everything that is ready right now; returns how many resumed.
+    size_t poll()
+    {
+        std::deque<std::coroutine_handle<>> batch;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            batch.swap(ready);
+        }
+        for (auto handle : batch)
+            handle.resume();
+        return batch.size();
+    }
+
+    void run()
+    {
+        for (;;)
+        {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wakeup.wait(lock, [this]
+                            { return stopped || !ready.empty(); });
+                if (stopped && ready.empty())
+                    return;
+            }
+            poll();
+        }
+    }
+
+    void stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopped = true;
+        }
+        wakeup.notify_all();
+    }
+
+private:
+    std::mutex mutex;
+    std::condition_variable wakeup;
+    std::deque<std::coroutine_handle<>> ready;
+    bool stopped = false;
+};
+
+// Awaitable front end for a FourierMotorManager. Feedback events are detected
+// on the manager's I/O worker (through its tick callback); blocking bridge
+// calls such as enable and the wait_ready() deadlines run on one helper
+// thread. Every coroutine is resumed on `loop`, so many supervisory tasks can
+// share one thread.
+//
+// Waiters are indexed by the motor's slot in manager.ids(), so a tick costs
+// O(1) per waiter however many motors the manager has.
+//
+// May be constructed before or after manager.start(); the manager must
+// outlive it. Destroying the adapter detaches its tick callback without
+// stopping the manager's worker, then resumes every coroutine still waiting
+// on it: next_feedback() with an invalid frame, wait_ready() with false. They
+// resume on `loop`, which must still be run or polled.
+class AsyncMotorManager
+{
+public:
+    AsyncMotorManager(FourierMotorManager &manager, MotorEventLoop &loop)
+        : manager(manager), loop(loop)
+    {
+        const std::vector<int32_t> &ids = manager.ids();
+        for (size_t i = 0; i < ids.size(); ++i)
+            slot_of.emplace(ids[i], i);
+        helper = std::thread([this]
+                             { run_calls(); });
+        manager.set_tick_callback([this](const std::vector<MotorFeedback> &feedback)
+                                  { on_tick(feedback); });
+    }
+
+    ~AsyncMotorManager()
+    {
+        manager.set_tick_callback(nullptr);
+        {
+            std::lock_guard<std::mutex> lock(calls_mutex);
+            calls_stopped = true;
+        }
+        calls_ready.notify_all();
+        helper.join();
+
+        std::lock_guard<std::mutex> lock(waiters_mutex);
+        for (auto &waiter : feedback_waiters)
+        {
+            waiter.result->valid = false;
+            loop.post(waiter.handle);
+        }
+        for (auto &waiter : ready_waiters)
+        {
+            *waiter.result = false;
+            loop.post(waiter.handle);
+        }
+        feedback_waiters.clear();
+        ready_waiters.clear();
+    }
+
+    AsyncMotorManager(const AsyncMotorManager &) = delete;
+    AsyncMotorManager &operator=(const AsyncMotorManager &) = delete;
+
+    template <typename T>
+    class BridgeCall
+    {
+    public:
+        BridgeCall(AsyncMotorManager &owner, std::function<T()> call)
+            : owner(owner), call(std::move(call)) {}
+
+        bool await_ready() const noexcept { return false; }
+
+        void await_suspend(std::coroutine_handle<> handle)
+        {
+            owner.submit([this, handle]
+                         {
+                             result = call();
+                             owner.loop.post(handle); });
+        }
+
+        T await_resume() { return std::move(result); }
+
+    private:
+        AsyncMotorManager &owner;
+        std::function<T()> call;
+        T result{};
+    };
+
+    BridgeCall<bool> enable_async(int32_t id)
+    {
+        return BridgeCall<bool>(*this, [this, id]
+                                { return manager.enable(id); });
+    }
+
+    BridgeCall<bool> disable_async(int32_t id)
+    {
+        return BridgeCall<bool>(*this, [this, id]
+                                { return manager.disable(id); });
+    }
+
+    BridgeCall<bool> set_control_mode_async(int32_t id, std::string mode)
+    {
+        return BridgeCall<bool>(*this, [this, id, mode]
+                                { return manager.set_control_mode(id, mode); });
+    }
+
+    // Resumes with the next valid feedback frame of `id` after the call; at
+    // once with an invalid frame if the manager has no motor `id`.
+    class FeedbackAwaiter
+    {
+    public:
+        FeedbackAwaiter(AsyncMotorManager &owner, int32_t id) : owner(owner), id(id) {}
+
+        bool await_ready() const noexcept { return false; }
+
+        void await_suspend(std::coroutine_handle<> handle)
+        {
+            auto it = owner.slot_of.find(id);
+            if (it == owner.slot_of.end())
+            {
+                owner.loop.post(handle);
+                return;
+            }
+            std::lock_guard<std::mutex> lock(owner.waiters_mutex);
+            owner.feedback_waiters.push_back({it->second, &result, handle});
+        }
+
+        MotorFeedback await_resume() { return result; }
+
+    private:
+        AsyncMotorManager &owner;
+        int32_t id;
+        MotorFeedback result;
+    };
+
+    FeedbackAwaiter next_feedback(int32_t id)
+    {
+        return FeedbackAwaiter(*this, id);
+    }
+
+    // Resumes with true once every id has reported valid feedback, or with
+    // false when `timeout` seconds pass first or an id is not the manager's.
+    class ReadyAwaiter
+    {
+    public:
+        ReadyAwaiter(AsyncMotorManager &owner, std::vector<int32_t> ids, double timeout)
+            : owner(owner), ids(std::move(ids)), deadline(monotonic_seconds() + timeout) {}
+
+        bool await_ready() const noexcept { return ids.empty(); }
+
+        void await_suspend(std::coroutine_handle<> handle)
+        {
+            ReadyWaiter waiter{{}, 0, deadline, &result, handle};
+            for (int32_t id : ids)
+            {
+                auto it = owner.slot_of.find(id);
+                if (it == owner.slot_of.end())
+                {
+                    owner.loop.post(handle);
+                    return;
+                }
+                waiter.slots.push_back(it->second);
+            }
+            {
+                std::lock_guard<std::mutex> lock(owner.waiters_mutex);
+                owner.ready_waiters.push_back(std::move(waiter));
+            }
+            owner.timers_changed();
+        }
+
+        bool await_resume() { return ids.empty() || result; }
+
+    private:
+        AsyncMotorManager &owner;
+        std::vector<int32_t> ids;
+        double deadline;
+        bool result = false;
+    };
+
+    ReadyAwaiter wait_ready(std::vector<int32_t> ids, double timeout)
+    {
+        return ReadyAwaiter(*this, std::move(ids), timeout);
+    }
+
+private:
+    struct FeedbackWaiter
+    {
+        size_t slot;
+        MotorFeedback *result;
+        std::coroutine_handle<> handle;
+    };
+
+    // `reported` counts the leading slots that have had valid feedback.
+    struct ReadyWaiter
+    {
+        std::vector<size_t> slots;
+        size_t reported;
+        double deadline;
+        bool *result;
+        std::coroutine_handle<> handle;
+    };
+
+    void on_tick(const std::vector<MotorFeedback> &feedback)
+    {
+        std::lock_guard<std::mutex> lock(waiters_mutex);
+        for (size_t i = 0; i < feedback_waiters.size();)
+        {
+            FeedbackWaiter &waiter = feedback_waiters[i];
+            const MotorFeedback &slot = feedback[waiter.slot];
+            if (slot.valid && slot.fresh)
+            {
+                *waiter.result = slot;
+                loop.post(waiter.handle);
+                feedback_waiters[i] = feedback_waiters.back();
+                feedback_waiters.pop_back();
+            }
+            else
+                ++i;
+        }
+
+        double now = monotonic_seconds();
+        for (size_t i = 0; i < ready_waiters.size();)
+        {
+            ReadyWaiter &waiter = ready_waiters[i];
+            while (waiter.reported < waiter.slots.size() && feedback[waiter.slots[waiter.reported]].valid)
+                ++waiter.reported;
+            bool all_valid = waiter.reported == waiter.slots.size();
+            if (all_valid || now >= waiter.deadline)
+            {
+                *waiter.result = all_valid;
+                loop.post(waiter.handle);
+                ready_waiters[i] = ready_waiters.back();
+                ready_waiters.pop_back();
+            }
+            else
+                ++i;
+        }
+    }
+
+    // Wakes the helper so it re-reads the earliest wait_ready() deadline.
+    void timers_changed()
+    {
+        {
+            std::lock_guard<std::mutex> lock(calls_mutex);
+            deadlines_changed = true;
+        }
+        calls_ready.notify_one();
+    }
+
+    double earliest_deadline()
+    {
+        std::lock_guard<std::mutex> lock(waiters_mutex);
+        double earliest = -1.0;
+        for (const auto &waiter : ready_waiters)
+        {
+            if (earliest < 0.0 || waiter.deadline < earliest)
+                earliest = waiter.deadline;
+        }
+        return earliest;
+    }
+
+    // Fails every wait_ready() whose deadline has passed, even while the
+    // worker is stopped and on_tick() never runs.
+    void expire_ready_waiters()
+    {
+        double now = monotonic_seconds();
+        std::lock_guard<std::mutex> lock(waiters_mutex);
+        for (size_t i = 0; i < ready_waiters.size();)
+        {
+            ReadyWaiter &waiter = ready_waiters[i];
+            if (now >= waiter.deadline)
+            {
+                *waiter.result = false;
+                loop.post(waiter.handle);
+                ready_waiters[i] = ready_waiters.back();
+                ready_waiters.pop_back();
+            }
+            else
+                ++i;
+        }
+    }
+
+    void submit(std::function<void()> call)
+    {
+        {
+            std::lock_guard<std::mutex> lock(calls_mutex);
+            calls.push_back(std::move(call));
+        }
+        calls_ready.notify_one();
+    }
+
+    void run_calls()
+    {
+        for (;;)
+        {
+            double deadline = earliest_deadline();
+            std::function<void()> call;
+            {
+                std::unique_lock<std::mutex> lock(calls_mutex);
+                auto wake = [this]
+                { return calls_stopped || !calls.empty() || deadlines_changed; };
+                if (deadline < 0.0)
+                    calls_ready.wait(lock, wake);
+                else
+                    calls_ready.wait_until(lock,
+                                           std::chrono::steady_clock::time_point(
+                                               std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                                   std::chrono::duration<double>(deadline))),
+                                           wake);
+                deadlines_changed = false;
+                if (calls_stopped && calls.empty())
+                    return;
+                if (!calls.empty())
+                {
+                    call = std::move(calls.front());
+                    calls.pop_front();
+                }
+            }
+            expire_ready_waiters();
+            if (call)
+                call();
+        }
+    }
+
+    FourierMotorManager &manager;
+    MotorEventLoop &loop;
+    std::unordered_map<int32_t, size_t> slot_of;
+
+    std::mutex waiters_mutex;
+    std::vector<FeedbackWaiter> feedback_waiters;
+    std::vector<ReadyWaiter> ready_waiters;
+
+    std::mutex calls_mutex;
+    std::condition_variable calls_ready;
+    std::deque<std::function<void()>> calls;
+    bool calls_stopped = false;
+    bool deadlines_changed = false;
+    std::thread helper;
+};
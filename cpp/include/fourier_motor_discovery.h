@@ -0,0 +1,87 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "rust/cxx.h"
+#include "fourier_comm/src/cpp.rs.h"
+#include "fourier_clock_sync.h"
+#include "fourier_motor_history.h"
+
+struct MotorManagerSync;
+
+struct DiscoveredMotor
+{
+    int32_t id = 0;
+    // Control mode reported by the motor; the bridge exposes no firmware or
+    // hardware type, so this is the only identifying detail available.
+    std::string control_mode;
+    // When the newest frame seen on the motor's first successful poll arrived,
+    // in seconds after the scan started (0 if it arrived before). Not a round
+    // trip: the bridge does not pair requests with replies.
+    double first_frame = 0.0;
+};
+
+// Probes every candidate id through a single bridge instance, so all of them
+// are asked at once and the scan takes about one `timeout`, not one per id.
+// Returns the ids that answered, in candidate order.
+inline std::vector<DiscoveredMotor> discover_motors(const std::vector<int32_t> &candidates, float timeout)
+{
+    std::vector<DiscoveredMotor> found;
+    if (candidates.empty())
+        return found;
+
+    double start = monotonic_seconds();
+    rust::Box<MotorManagerSync> probe = make_motor_manager_v1(candidates);
+    std::vector<double> first_seen(candidates.size(), -1.0);
+    size_t remaining = candidates.size();
+
+    while (remaining > 0 && monotonic_seconds() - start < timeout)
+    {
+        for (size_t i = 0; i < candidates.size(); ++i)
+        {
+            if (first_seen[i] >= 0.0)
+                continue;
+            double now = monotonic_seconds();
+            double age = 0.0;
+            if (!parse_motor_age(std::string(probe->cxx_get_motor_state(candidates[i])), age))
+                continue;
+            try
+            {
+                probe->cxx_get_position(candidates[i]);
+            }
+            catch (const rust::Error &)
+            {
+                continue;
+            }
+            first_seen[i] = now - age;
+            --remaining;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    for (size_t i = 0; i < candidates.size(); ++i)
+    {
+        if (first_seen[i] < 0.0)
+            continue;
+        DiscoveredMotor motor;
+        motor.id = candidates[i];
+        motor.control_mode = std::string(probe->cxx_get_control_mode(motor.id));
+        motor.first_frame = first_seen[i] > start ? first_seen[i] - start : 0.0;
+        found.push_back(motor);
+    }
+    probe->cxx_stop();
+    return found;
+}
+
+// Scans the inclusive id range [first_id, last_id].
+inline std::vector<DiscoveredMotor> discover_motors(int32_t first_id, int32_t last_id, float timeout)
+{
+    std::vector<int32_t> candidates;
+    // 64-bit counter so last_id == INT32_MAX terminates.
+    for (int64_t id = first_id; id <= last_id; ++id)
+        candidates.push_back(int32_t(id));
+    return discover_motors(candidates, timeout);
+}
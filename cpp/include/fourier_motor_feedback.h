@@ -0,0 +1,189 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+enum FeedbackField : uint8_t
+{
+    FEEDBACK_POSITION = 1 << 0,
+    FEEDBACK_VELOCITY = 1 << 1,
+    FEEDBACK_CURRENT = 1 << 2,
+    FEEDBACK_EFFORT = 1 << 3,
+    FEEDBACK_ALL = FEEDBACK_POSITION | FEEDBACK_VELOCITY | FEEDBACK_CURRENT | FEEDBACK_EFFORT,
+};
+
+// LIVE and STALE follow the feedback age; a LOST motor stays lost until the
+// manager's recovery thread has re-enabled it and restored its mode.
+enum class MotorHealth : uint8_t
+{
+    LIVE,
+    STALE,
+    LOST,
+    RECOVERING,
+};
+
+struct MotorFeedback
+{
+    int32_t id = 0;
+    float position = 0.0f;
+    float velocity = 0.0f;
+    float current = 0.0f;
+    float effort = 0.0f;
+    float filtered_position = 0.0f;
+    float filtered_velocity = 0.0f;
+    float filtered_acceleration = 0.0f;
+    // Host monotonic time of the frame (see monotonic_seconds()). With clock
+    // sync enabled this is the drift-corrected arrival time and `fresh` tells
+    // whether the frame is new since the previous tick.
+    double timestamp = 0.0;
+    double timestamp_uncertainty = 0.0;
+    // Time between the transport receiving the frame and the worker reading
+    // it (only with clock sync enabled, which reads the age).
+    double age = 0.0;
+    // FeedbackField bits read for this frame (see set_feedback_fields());
+    // position, velocity, current and effort not in it are NaN.
+    uint8_t fields = 0;
+    bool fresh = false;
+    bool valid = false;
+    MotorHealth health = MotorHealth::LIVE;
+};
+
+// One motor's latest feedback in its own cache lines, guarded by a seqlock.
+// The single writer (the I/O worker) never waits; readers retry only if they
+// overlapped a write. Giving every motor its own 64-byte aligned slot keeps
+// readers of different limbs from invalidating each other's cache lines.
+class alignas(64) MotorFeedbackSlot
+{
+public:
+    void store(const MotorFeedback &value)
+    {
+        uint64_t words[word_count] = {};
+        std::memcpy(words, &value, sizeof(MotorFeedback));
+        uint32_t seq = sequence.load(std::memory_order_relaxed);
+        sequence.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i = 0; i < word_count; ++i)
+            data[i].store(words[i], std::memory_order_relaxed);
+        sequence.store(seq + 2, std::memory_order_release);
+    }
+
+    void load(MotorFeedback &value) const
+    {
+        uint64_t words[word_count];
+        for (;;)
+        {
+            uint32_t before = sequence.load(std::memory_order_acquire);
+            if (before & 1)
+                continue;
+            for (size_t i = 0; i < word_count; ++i)
+                words[i] = data[i].load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (sequence.load(std::memory_order_relaxed) == before)
+                break;
+        }
+        std::memcpy(&value, words, sizeof(MotorFeedback));
+    }
+
+private:
+    static_assert(std::is_trivially_copyable<MotorFeedback>::value, "MotorFeedback is copied word by word");
+    static constexpr size_t word_count = (sizeof(MotorFeedback) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    std::atomic<uint32_t> sequence{0};
+    std::atomic<uint64_t> data[word_count] = {};
+};
+
+// Feedback of every motor from one worker tick.
+struct FeedbackSnapshot
+{
+    uint64_t epoch = 0;
+    double timestamp = 0.0;
+    std::vector<MotorFeedback> motors;
+};
+
+// Triple-buffered publication of whole ticks. The writer fills the copy after
+// the latest one and never waits; a reader copies the latest complete tick and
+// retries only if the writer lapped it twice during the copy. Every motor in a
+// snapshot therefore comes from the same feedback round.
+class FeedbackSnapshotBuffer
+{
+public:
+    explicit FeedbackSnapshotBuffer(size_t motors)
+        : motor_count(motors), words_per_copy(motors * words_per_motor)
+    {
+        for (auto &copy : copies)
+            copy.words.reset(new std::atomic<uint64_t>[words_per_copy ? words_per_copy : 1]());
+    }
+
+    // Single writer.
+    void publish(const std::vector<MotorFeedback> &motors, double timestamp)
+    {
+        uint64_t epoch = latest.load(std::memory_order_relaxed) + 1;
+        Copy &copy = copies[epoch % copy_count];
+        copy.sequence.store(2 * epoch - 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        uint64_t words[words_per_motor];
+        for (size_t m = 0; m < motor_count && m < motors.size(); ++m)
+        {
+            std::memset(words, 0, sizeof(words));
+            std::memcpy(words, &motors[m], sizeof(MotorFeedback));
+            for (size_t w = 0; w < words_per_motor; ++w)
+                copy.words[m * words_per_motor + w].store(words[w], std::memory_order_relaxed);
+        }
+        copy.timestamp.store(timestamp, std::memory_order_relaxed);
+        copy.sequence.store(2 * epoch, std::memory_order_release);
+        latest.store(epoch, std::memory_order_release);
+    }
+
+    // Copies the latest complete tick; false until the first publish().
+    bool read(FeedbackSnapshot &out) const
+    {
+        out.motors.resize(motor_count);
+        uint64_t words[words_per_motor];
+        for (;;)
+        {
+            uint64_t epoch = latest.load(std::memory_order_acquire);
+            if (epoch == 0)
+                return false;
+            const Copy &copy = copies[epoch % copy_count];
+            if (copy.sequence.load(std::memory_order_acquire) != 2 * epoch)
+                continue;
+            for (size_t m = 0; m < motor_count; ++m)
+            {
+                for (size_t w = 0; w < words_per_motor; ++w)
+                    words[w] = copy.words[m * words_per_motor + w].load(std::memory_order_relaxed);
+                std::memcpy(&out.motors[m], words, sizeof(MotorFeedback));
+            }
+            out.timestamp = copy.timestamp.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (copy.sequence.load(std::memory_order_relaxed) != 2 * epoch)
+                continue;
+            out.epoch = epoch;
+            return true;
+        }
+    }
+
+    uint64_t epoch() const
+    {
+        return latest.load(std::memory_order_acquire);
+    }
+
+private:
+    static constexpr size_t copy_count = 3;
+    static constexpr size_t words_per_motor = (sizeof(MotorFeedback) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    struct alignas(64) Copy
+    {
+        std::atomic<uint64_t> sequence{0};
+        std::atomic<double> timestamp{0.0};
+        std::unique_ptr<std::atomic<uint64_t>[]> words;
+    };
+
+    size_t motor_count;
+    size_t words_per_copy;
+    Copy copies[copy_count];
+    alignas(64) std::atomic<uint64_t> latest{0};
+};
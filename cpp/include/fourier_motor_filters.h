@@ -0,0 +1,183 @@
+#pragma once
+
+#include <cmath>
+
+enum class FeedbackFilter
+{
+    NONE,
+    ALPHA_BETA_GAMMA,
+    BUTTERWORTH,
+};
+
+struct FilterConfig
+{
+    FeedbackFilter kind = FeedbackFilter::NONE;
+    // alpha-beta-gamma tracker gains
+    float alpha = 0.5f;
+    float beta = 0.1f;
+    float gamma = 0.01f;
+    // Butterworth cutoff; clamped below Nyquist of the sample rate
+    float cutoff_hz = 50.0f;
+};
+
+// Constant-acceleration tracker: predicts with the current estimate, then
+// corrects position, velocity and acceleration by fixed fractions of the
+// residual. A sample that does not advance time (dt <= 0) is skipped.
+class AlphaBetaGammaFilter
+{
+public:
+    void configure(float alpha, float beta, float gamma)
+    {
+        a = alpha;
+        b = beta;
+        g = gamma;
+    }
+
+    void update(float measurement, float dt)
+    {
+        if (!initialized)
+        {
+            position = measurement;
+            velocity = 0.0f;
+            acceleration = 0.0f;
+            initialized = true;
+            return;
+        }
+        if (dt <= 0.0f)
+            return;
+        position += velocity * dt + 0.5f * acceleration * dt * dt;
+        velocity += acceleration * dt;
+        float residual = measurement - position;
+        position += a * residual;
+        velocity += b / dt * residual;
+        acceleration += 2.0f * g / (dt * dt) * residual;
+    }
+
+    float position = 0.0f;
+    float velocity = 0.0f;
+    float acceleration = 0.0f;
+
+private:
+    float a = 0.5f;
+    float b = 0.1f;
+    float g = 0.01f;
+    bool initialized = false;
+};
+
+// Second-order Butterworth low-pass (bilinear transform, direct form II
+// transposed).
+class ButterworthLowPass
+{
+public:
+    void configure(float cutoff_hz, float sample_rate_hz)
+    {
+        float nyquist = 0.5f * sample_rate_hz;
+        if (cutoff_hz > 0.9f * nyquist)
+            cutoff_hz = 0.9f * nyquist;
+        const float pi = 3.14159265358979f;
+        float k = std::tan(pi * cutoff_hz / sample_rate_hz);
+        float norm = 1.0f / (1.0f + std::sqrt(2.0f) * k + k * k);
+        b0 = k * k * norm;
+        b1 = 2.0f * b0;
+        b2 = b0;
+        a1 = 2.0f * (k * k - 1.0f) * norm;
+        a2 = (1.0f - std::sqrt(2.0f) * k + k * k) * norm;
+        initialized = false;
+    }
+
+    float update(float x)
+    {
+        if (!initialized)
+        {
+            // Start at steady state so the first output equals the input.
+            z1 = x * (1.0f - b0);
+            z2 = x * (b2 - a2);
+            initialized = true;
+        }
+        float y = b0 * x + z1;
+        z1 = b1 * x - a1 * y + z2;
+        z2 = b2 * x - a2 * y;
+        return y;
+    }
+
+private:
+    float b0 = 1.0f, b1 = 0.0f, b2 = 0.0f, a1 = 0.0f, a2 = 0.0f;
+    float z1 = 0.0f, z2 = 0.0f;
+    bool initialized = false;
+};
+
+// Per-motor estimator fed with every decoded position sample. Once it has
+// a sample, one that does not advance time (dt <= 0, e.g. after a clock-sync
+// refit moved the timestamp back) is skipped instead of restarting it.
+class MotorStateFilter
+{
+public:
+    void configure(const FilterConfig &config, float sample_rate_hz)
+    {
+        kind = config.kind;
+        cutoff_hz = config.cutoff_hz;
+        tracker = AlphaBetaGammaFilter();
+        tracker.configure(config.alpha, config.beta, config.gamma);
+        set_sample_rate(sample_rate_hz);
+        has_previous = false;
+    }
+
+    // Redesigns the Butterworth stages for a new sample rate; they restart
+    // from their next input.
+    void set_sample_rate(float sample_rate_hz)
+    {
+        rate_hz = sample_rate_hz;
+        for (auto &stage : stages)
+            stage.configure(cutoff_hz, sample_rate_hz);
+    }
+
+    float sample_rate() const
+    {
+        return rate_hz;
+    }
+
+    void update(float measured_position, float measured_velocity, float dt)
+    {
+        if (kind != FeedbackFilter::NONE && has_previous && dt <= 0.0f)
+            return;
+        switch (kind)
+        {
+        case FeedbackFilter::ALPHA_BETA_GAMMA:
+            tracker.update(measured_position, dt);
+            position = tracker.position;
+            velocity = tracker.velocity;
+            acceleration = tracker.acceleration;
+            has_previous = true;
+            break;
+        case FeedbackFilter::BUTTERWORTH:
+        {
+            float filtered = stages[0].update(measured_position);
+            float raw_velocity = has_previous ? (filtered - position) / dt : 0.0f;
+            float smoothed = stages[1].update(raw_velocity);
+            float raw_acceleration = has_previous ? (smoothed - velocity) / dt : 0.0f;
+            acceleration = stages[2].update(raw_acceleration);
+            position = filtered;
+            velocity = smoothed;
+            has_previous = true;
+            break;
+        }
+        default:
+            position = measured_position;
+            velocity = measured_velocity;
+            acceleration = 0.0f;
+            break;
+        }
+    }
+
+    float position = 0.0f;
+    float velocity = 0.0f;
+    float acceleration = 0.0f;
+
+private:
+    FeedbackFilter kind = FeedbackFilter::NONE;
+    float cutoff_hz = 50.0f;
+    float rate_hz = 0.0f;
+    AlphaBetaGammaFilter tracker;
+    ButterworthLowPass stages[3];
+    bool has_previous = false;
+};
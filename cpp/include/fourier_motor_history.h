@@ -0,0 +1,144 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
+// Seconds on std::chrono::steady_clock, i.e. CLOCK_MONOTONIC on Linux. All
+// history timestamps use this clock.
+inline double monotonic_seconds()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+struct MotorSample
+{
+    double time = 0.0;
+    float position = 0.0f;
+    float velocity = 0.0f;
+    float current = 0.0f;
+    float effort = 0.0f;
+};
+
+// Fixed-capacity ring of timestamped samples for one motor. A single writer
+// (the manager's I/O worker) pushes samples with increasing timestamps; any
+// number of readers query it without locks. Readers validate against the
+// write counter after copying and retry if the writer lapped them.
+class MotorHistory
+{
+public:
+    explicit MotorHistory(size_t capacity)
+        : slots(new Slot[capacity < 2 ? 2 : capacity]), capacity(capacity < 2 ? 2 : capacity) {}
+
+    void push(const MotorSample &sample)
+    {
+        uint64_t index = head.load(std::memory_order_relaxed);
+        Slot &slot = slots[index % capacity];
+        // Orders the previous head store before the slot is overwritten, so a
+        // reader that sees new slot contents also sees a head that rejects them.
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.time.store(sample.time, std::memory_order_relaxed);
+        slot.position.store(sample.position, std::memory_order_relaxed);
+        slot.velocity.store(sample.velocity, std::memory_order_relaxed);
+        slot.current.store(sample.current, std::memory_order_relaxed);
+        slot.effort.store(sample.effort, std::memory_order_relaxed);
+        head.store(index + 1, std::memory_order_release);
+    }
+
+    size_t size() const
+    {
+        uint64_t end = head.load(std::memory_order_acquire);
+        return end < capacity ? size_t(end) : capacity - 1;
+    }
+
+    bool latest(MotorSample &out) const
+    {
+        uint64_t end = head.load(std::memory_order_acquire);
+        if (end == 0)
+            return false;
+        load(end - 1, out);
+        return true;
+    }
+
+    // Linear interpolation between the two samples bracketing `time`, found by
+    // binary search. Returns false when `time` lies outside the stored window;
+    // `out` then holds the nearest stored sample, if there is one.
+    bool sample_at(double time, MotorSample &out) const
+    {
+        for (int attempt = 0; attempt < 8; ++attempt)
+        {
+            uint64_t end = head.load(std::memory_order_acquire);
+            if (end == 0)
+                return false;
+            // The oldest slot is the next one to be overwritten; leave it out.
+            uint64_t begin = end >= capacity ? end - capacity + 1 : 0;
+
+            uint64_t lo = begin;
+            uint64_t hi = end;
+            while (lo < hi)
+            {
+                uint64_t mid = lo + (hi - lo) / 2;
+                if (slots[mid % capacity].time.load(std::memory_order_relaxed) <= time)
+                    lo = mid + 1;
+                else
+                    hi = mid;
+            }
+
+            MotorSample before;
+            MotorSample after;
+            bool inside = lo > begin && lo < end;
+            uint64_t oldest = inside ? lo - 1 : (lo == begin ? begin : end - 1);
+            load(oldest, before);
+            if (inside)
+                load(lo, after);
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            uint64_t now = head.load(std::memory_order_relaxed);
+            if (now >= capacity && oldest < now - capacity + 1)
+                continue;
+
+            if (!inside)
+            {
+                out = before;
+                return before.time == time;
+            }
+            if (!(before.time <= time && time < after.time))
+                continue;
+
+            double span = after.time - before.time;
+            float alpha = span > 0.0 ? float((time - before.time) / span) : 0.0f;
+            out.time = time;
+            out.position = before.position + alpha * (after.position - before.position);
+            out.velocity = before.velocity + alpha * (after.velocity - before.velocity);
+            out.current = before.current + alpha * (after.current - before.current);
+            out.effort = before.effort + alpha * (after.effort - before.effort);
+            return true;
+        }
+        return false;
+    }
+
+private:
+    struct Slot
+    {
+        std::atomic<double> time{0.0};
+        std::atomic<float> position{0.0f};
+        std::atomic<float> velocity{0.0f};
+        std::atomic<float> current{0.0f};
+        std::atomic<float> effort{0.0f};
+    };
+
+    void load(uint64_t index, MotorSample &out) const
+    {
+        const Slot &slot = slots[index % capacity];
+        out.time = slot.time.load(std::memory_order_relaxed);
+        out.position = slot.position.load(std::memory_order_relaxed);
+        out.velocity = slot.velocity.load(std::memory_order_relaxed);
+        out.current = slot.current.load(std::memory_order_relaxed);
+        out.effort = slot.effort.load(std::memory_order_relaxed);
+    }
+
+    std::unique_ptr<Slot[]> slots;
+    size_t capacity;
+    std::atomic<uint64_t> head{0};
+};
@@ -1,16 +1,196 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <functional>
+#include <limits>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <queue>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
 #include "rust/cxx.h"
 #include "fourier_comm/src/cpp.rs.h"
+#include "fourier_clock_sync.h"
+#include "fourier_io_executor.h"
+#include "fourier_joint_calibration.h"
+#include "fourier_joint_limits.h"
+#include "fourier_link_monitor.h"
+#include "fourier_motor_feedback.h"
+#include "fourier_motor_filters.h"
+#include "fourier_motor_history.h"
+#include "fourier_pcap_capture.h"
+#include "fourier_topology_cache.h"
 
 struct MotorManagerSync;
 
+struct CommandStats
+{
+    uint64_t writes = 0;
+    uint64_t coalesced = 0;
+    uint64_t flushed = 0;
+    uint64_t failed = 0;
+};
+
+// What a setter does when the motor already has a staged, not yet sent
+// command of the same type: replace it (the default coalescing), refuse the
+// new one, or wait up to the block timeout for the worker to take the old one.
+enum class OverflowPolicy : uint8_t
+{
+    DROP_OLDEST,
+    DROP_NEWEST,
+    BLOCK,
+};
+
+// Outgoing command queue of a running manager. `depth` counts the commands
+// staged for the next tick; an overflow is a write that found its slot still
+// occupied, resolved by the policy into dropped_oldest (replaced),
+// dropped_newest (refused) or a block that either got room or timed out.
+// Latency runs from the setter staging a command to its bridge call returning.
+struct QueueStats
+{
+    uint64_t depth = 0;
+    uint64_t max_depth = 0;
+    uint64_t overflows = 0;
+    uint64_t dropped_oldest = 0;
+    uint64_t dropped_newest = 0;
+    uint64_t blocked = 0;
+    uint64_t timeouts = 0;
+    uint64_t sent = 0;
+    double latency_last = 0.0;
+    double latency_mean = 0.0;
+    double latency_max = 0.0;
+};
+
+// Bridge calls made by the manager. Each one is at least one trip into the
+// Rust transport, so calls per tick bound the transport's work per tick.
+struct IoStats
+{
+    uint64_t ticks = 0;
+    uint64_t bridge_calls = 0;
+    uint64_t last_tick_calls = 0;
+    uint64_t max_tick_calls = 0;
+};
+
+// Splits feedback latency into the part spent before the worker looked at the
+// frame (age: transport receive to worker read) and the worker's own
+// scheduling delay (wakeup: scheduled tick time to actual wake-up).
+struct LatencyStats
+{
+    uint64_t ticks = 0;
+    double wakeup_last = 0.0;
+    double wakeup_mean = 0.0;
+    double wakeup_max = 0.0;
+    double age_last = 0.0;
+    double age_max = 0.0;
+};
+
+// Timing of scheduled commands. Lateness is dispatch time minus requested
+// time; it is negative when the closest tick came slightly before the deadline.
+// Cancelled counts entries dropped by stop() and entries the DROP_NEWEST
+// overflow policy refused because a setter had already taken their slot.
+struct ScheduleStats
+{
+    uint64_t scheduled = 0;
+    uint64_t dispatched = 0;
+    uint64_t cancelled = 0;
+    size_t pending = 0;
+    double lateness_last = 0.0;
+    double lateness_mean = 0.0;
+    double lateness_max = 0.0;
+};
+
+// Spread between the first and the last bridge send of one flush, i.e. how
+// much later the last joint of a tick is commanded than the first.
+struct SkewStats
+{
+    uint64_t flushes = 0;
+    double last = 0.0;
+    double mean = 0.0;
+    double max = 0.0;
+};
+
+// Feedback age thresholds (seconds) of the health monitor, and how long a
+// lost motor waits between reconnect attempts.
+struct HealthConfig
+{
+    double stale_after = 0.05;
+    double lost_after = 0.5;
+    double retry_interval = 0.5;
+};
+
+struct HealthStats
+{
+    MotorHealth state = MotorHealth::LIVE;
+    uint64_t losses = 0;
+    uint64_t recoveries = 0;
+    uint64_t failed_attempts = 0;
+};
+
+// Gains for several motors, uploaded together. Only the id and the gain
+// fields of each entry are used; has_pid_gain / has_pd_gain select which
+// gains an entry changes.
+using GainTable = std::vector<MotorConfig>;
+
+// Outcome of one gain table. Acknowledged and failed count bridge calls;
+// upload_time runs from the first gain call of the table to the last one
+// returning. A table still pending when the worker stops is cancelled.
+struct GainTableResult
+{
+    uint64_t requested_tick = 0;
+    uint64_t applied_tick = 0;
+    size_t acknowledged = 0;
+    size_t failed = 0;
+    double upload_time = 0.0;
+    bool cancelled = false;
+};
+
 class FourierMotorManager
 {
 
 public:
     FourierMotorManager(const std::vector<int32_t> &ids)
-        : manager(make_motor_manager_v1(ids)) {}
+        : manager(make_motor_manager_v1(ids)), motor_ids(ids), snapshots(ids.size()),
+          joints(JointCalibration(), ids), limiter(JointCalibration(), joints, ids)
+    {
+        for (size_t i = 0; i < ids.size(); ++i)
+            slot_of.emplace(ids[i], i);
+        configs.resize(ids.size());
+        for (size_t i = 0; i < ids.size(); ++i)
+            configs[i].id = ids[i];
+        staging[0].resize(ids.size());
+        staging[1].resize(ids.size());
+        filters.resize(ids.size());
+        enabled_motors.assign(ids.size(), false);
+        slots.reset(new MotorFeedbackSlot[ids.size()]);
+        for (size_t i = 0; i < ids.size(); ++i)
+        {
+            MotorFeedback initial;
+            initial.id = ids[i];
+            slots[i].store(initial);
+        }
+    }
+
+    ~FourierMotorManager()
+    {
+        stop();
+    }
+
+    FourierMotorManager(const FourierMotorManager &) = delete;
+    FourierMotorManager &operator=(const FourierMotorManager &) = delete;
+
+    const std::vector<int32_t> &ids() const
+    {
+        return motor_ids;
+    }
 
     bool wait_for_first_messages(float timeout)
     {
@@ -19,17 +199,29 @@ public:
 
     bool enable(int32_t id)
     {
-        return manager->cxx_enable(id);
+        bool ok = manager->cxx_enable(id);
+        trace(CaptureDirection::TX, "enable", id, ok);
+        if (ok)
+            remember_enabled(id, true);
+        return ok;
     }
 
     bool disable(int32_t id)
     {
-        return manager->cxx_disable(id);
+        bool ok = manager->cxx_disable(id);
+        trace(CaptureDirection::TX, "disable", id, ok);
+        if (ok)
+            remember_enabled(id, false);
+        return ok;
     }
 
     bool set_position(int32_t id, float value)
     {
-        return manager->cxx_set_position(id, value);
+        if (!limit(id, POSITION, value))
+            return false;
+        if (running())
+            return stage(id, POSITION, value);
+        return send_command(id, POSITION, value);
     }
 
     float get_position(int32_t id)
@@ -44,7 +236,11 @@ public:
 
     float set_velocity(int32_t id, float value)
     {
-        return manager->cxx_set_velocity(id, value);
+        if (!limit(id, VELOCITY, value))
+            return false;
+        if (running())
+            return stage(id, VELOCITY, value);
+        return send_command(id, VELOCITY, value);
     }
 
     float get_current(int32_t id)
@@ -54,7 +250,11 @@ public:
 
     float set_current(int32_t id, float value)
     {
-        return manager->cxx_set_current(id, value);
+        if (!limit(id, CURRENT, value))
+            return false;
+        if (running())
+            return stage(id, CURRENT, value);
+        return send_command(id, CURRENT, value);
     }
 
     float get_effort(int32_t id)
@@ -64,12 +264,107 @@ public:
 
     float set_effort(int32_t id, float value)
     {
-        return manager->cxx_set_effort(id, value);
+        if (!limit(id, EFFORT, value))
+            return false;
+        if (running())
+            return stage(id, EFFORT, value);
+        return send_command(id, EFFORT, value);
     }
 
     bool set_control_mode(int32_t id, std::string mode)
     {
-        return manager->cxx_set_control_mode(id, mode);
+        bool ok = manager->cxx_set_control_mode(id, mode);
+        trace(CaptureDirection::TX, "set_control_mode", id, ok);
+        if (!ok)
+            return false;
+        MotorConfig *config = config_for(id);
+        if (config)
+        {
+            std::lock_guard<std::mutex> lock(config_mutex);
+            config->control_mode = mode;
+        }
+        return true;
+    }
+
+    bool set_motor_pid_gain(int32_t id, float position_kp, float velocity_kp, float velocity_ki)
+    {
+        bool ok = manager->cxx_set_motor_pid_gain(id, position_kp, velocity_kp, velocity_ki);
+        bridge_calls.fetch_add(1, std::memory_order_relaxed);
+        trace(CaptureDirection::TX, "set_motor_pid_gain", id, ok, {position_kp, velocity_kp, velocity_ki});
+        if (!ok)
+            return false;
+        MotorConfig *config = config_for(id);
+        if (config)
+        {
+            std::lock_guard<std::mutex> lock(config_mutex);
+            config->has_pid_gain = true;
+            config->position_kp = position_kp;
+            config->velocity_kp = velocity_kp;
+            config->velocity_ki = velocity_ki;
+        }
+        return true;
+    }
+
+    bool set_control_pd_gain(int32_t id, float kp, float kd)
+    {
+        bool ok = manager->cxx_set_control_pd_gain(id, kp, kd);
+        bridge_calls.fetch_add(1, std::memory_order_relaxed);
+        trace(CaptureDirection::TX, "set_control_pd_gain", id, ok, {kp, kd});
+        if (!ok)
+            return false;
+        MotorConfig *config = config_for(id);
+        if (config)
+        {
+            std::lock_guard<std::mutex> lock(config_mutex);
+            config->has_pd_gain = true;
+            config->kp = kp;
+            config->kd = kd;
+        }
+        return true;
+    }
+
+    // Uploads a gain table. Without the worker it is sent at once and the
+    // result tells whether every gain call succeeded. With the worker running
+    // the table goes out on the next tick and true only means it was queued;
+    // use set_gains_at() to learn whether the upload succeeded.
+    bool set_gains(const GainTable &table)
+    {
+        if (running())
+        {
+            set_gains_at(table, current_tick());
+            return true;
+        }
+        GainTableResult result = apply_gains(table);
+        return result.failed == 0;
+    }
+
+    // Hands a gain table to the worker, which uploads all of it at the start
+    // of tick `tick` (see current_tick()), before that tick's commands go out.
+    // A tick already in the past means the next one. Without a running worker
+    // the table is uploaded at once.
+    std::future<GainTableResult> set_gains_at(const GainTable &table, uint64_t tick)
+    {
+        std::promise<GainTableResult> done;
+        std::future<GainTableResult> result = done.get_future();
+        {
+            std::lock_guard<std::mutex> lock(gain_mutex);
+            if (running())
+            {
+                pending_gains.push_back({tick, table, std::move(done)});
+                return result;
+            }
+        }
+        GainTableResult applied = apply_gains(table);
+        applied.requested_tick = tick;
+        done.set_value(applied);
+        return result;
+    }
+
+    // Number of ticks the worker has completed; the tick running now, or the
+    // next one, has this number.
+    uint64_t current_tick() const
+    {
+        return io_ticks.load(std::memory_order_relaxed);
     }
 
     std::string get_control_mode(int32_t id)
@@ -84,6 +379,1632 @@ public:
         return std::string(state);
     }
 
+    // Reads every motor of this manager straight from the bridge. `out` is
+    // resized to ids().size() and keeps the order of ids(). A motor the bridge
+    // refuses to report is marked invalid instead of aborting the batch.
+    // Only the fields selected by set_feedback_fields() are read; the others
+    // are set to NaN and left out of MotorFeedback::fields.
+    bool read_feedback(std::vector<MotorFeedback> &out)
+    {
+        out.resize(motor_ids.size());
+        uint8_t fields = feedback_fields.load(std::memory_order_relaxed);
+        const float unread = std::numeric_limits<float>::quiet_NaN();
+        uint64_t calls = 0;
+        bool ok = true;
+        for (size_t i = 0; i < motor_ids.size(); ++i)
+        {
+            MotorFeedback &slot = out[i];
+            slot.id = motor_ids[i];
+            try
+            {
+                slot.position = slot.velocity = slot.current = slot.effort = unread;
+                if (fields & FEEDBACK_POSITION)
+                {
+                    ++calls;
+                    slot.position = manager->cxx_get_position(slot.id);
+                }
+                if (fields & FEEDBACK_VELOCITY)
+                {
+                    ++calls;
+                    slot.velocity = manager->cxx_get_velocity(slot.id);
+                }
+                if (fields & FEEDBACK_CURRENT)
+                {
+                    ++calls;
+                    slot.current = manager->cxx_get_current(slot.id);
+                }
+                if (fields & FEEDBACK_EFFORT)
+                {
+                    ++calls;
+                    slot.effort = manager->cxx_get_effort(slot.id);
+                }
+                slot.fields = fields;
+                slot.valid = true;
+            }
+            catch (const rust::Error &)
+            {
+                slot.fields = 0;
+                slot.valid = false;
+                ok = false;
+            }
+            trace(CaptureDirection::RX, "feedback", slot.id, slot.valid,
+                  {slot.position, slot.velocity, slot.current, slot.effort});
+        }
+        bridge_calls.fetch_add(calls, std::memory_order_relaxed);
+        return ok;
+    }
+
+    // Starts the I/O worker that refreshes the feedback snapshot at `rate_hz`.
+    // While it runs, set_position/velocity/current/effort only stage the value;
+    // the worker flushes the last value per motor and command type once per tick.
+    bool start(float rate_hz)
+    {
+        if (!prepare_start(rate_hz))
+            return false;
+        auto period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(tick_period));
+        start_recovery();
+        worker = std::thread([this, period]
+                             { run(period); });
+        return true;
+    }
+
+    // Same as start(rate_hz), but the ticks run on one of `executor`'s
+    // threads instead of a thread of this manager's own. The executor must
+    // outlive the running state; stop() unregisters.
+    bool start(FourierIoExecutor &executor, float rate_hz)
+    {
+        if (!prepare_start(rate_hz))
+            return false;
+        io_executor = &executor;
+        start_recovery();
+        executor_task = executor.add([this](double lateness)
+                                     {
+                                         record_wakeup(lateness);
+                                         tick(executor_buffer); },
+                                     tick_period);
+        return true;
+    }
+
+    void stop()
+    {
+        worker_running.store(false, std::memory_order_release);
+        stop_recovery();
+        if (worker.joinable())
+        {
+            worker.join();
+            flush_commands();
+        }
+        if (io_executor)
+        {
+            io_executor->remove(executor_task);
+            io_executor = nullptr;
+            flush_commands();
+        }
+        cancel_gains();
+        std::lock_guard<std::mutex> lock(schedule_mutex);
+        schedule_cancelled += scheduled.size();
+        scheduled = std::priority_queue<ScheduledCommand, std::vector<ScheduledCommand>, std::greater<ScheduledCommand>>();
+    }
+
+    bool running() const
+    {
+        return worker_running.load(std::memory_order_acquire);
+    }
+
+    // Latest feedback of every motor, in ids() order. Without a running worker
+    // this reads the bridge directly.
+    void snapshot(std::vector<MotorFeedback> &out)
+    {
+        if (!running())
+        {
+            read_feedback(out);
+            return;
+        }
+        FeedbackSnapshot tick;
+        if (snapshots.read(tick))
+            out.swap(tick.motors);
+        else
+            read_feedback(out);
+    }
+
+    // All motors from the latest complete worker tick, tagged with the tick's
+    // epoch and start time. Never blocks the worker and is never blocked by
+    // it. Returns false before the worker has published its first tick.
+    bool snapshot(FeedbackSnapshot &out) const
+    {
+        return snapshots.read(out);
+    }
+
+    // Latest feedback of one motor as published by the worker. Lock-free and
+    // cheap enough for several control threads to poll their own joints.
+    bool feedback_of(int32_t id, MotorFeedback &out) const
+    {
+        auto it = slot_of.find(id);
+        if (it == slot_of.end())
+            return false;
+        slots[it->second].load(out);
+        return true;
+    }
+
+    // Impedance-style command: position, velocity and feed-forward torque
+    // targets plus the PD gains, applied together. While the worker runs all
+    // terms are staged under one lock and leave on the same tick; PD gains are
+    // only resent when they change. Without the worker they are sent at once.
+    bool set_command(int32_t id, float position, float velocity, float effort, float kp, float kd)
+    {
+        auto it = slot_of.find(id);
+        if (it == slot_of.end())
+            return false;
+        if (!limit_terms(it->second, position, velocity, effort))
+            return false;
+        if (running())
+        {
+            std::unique_lock<std::mutex> lock(staging_mutex);
+            return stage_terms(lock, it->second, position, velocity, effort, kp, kd);
+        }
+        bool ok = send_gains(it->second, kp, kd);
+        ok = send_command(id, POSITION, position) && ok;
+        ok = send_command(id, VELOCITY, velocity) && ok;
+        return send_command(id, EFFORT, effort) && ok;
+    }
+
+    // Batched set_command(); all vectors must have the same length. With the
+    // worker running every motor's terms are staged under a single lock.
+    bool set_commands(const std::vector<int32_t> &ids,
+                      const std::vector<float> &positions, const std::vector<float> &velocities,
+                      const std::vector<float> &efforts, const std::vector<float> &kps,
+                      const std::vector<float> &kds)
+    {
+        size_t count = ids.size();
+        if (positions.size() != count || velocities.size() != count || efforts.size() != count ||
+            kps.size() != count || kds.size() != count)
+            return false;
+        if (!running())
+        {
+            bool ok = true;
+            for (size_t i = 0; i < count; ++i)
+                ok = set_command(ids[i], positions[i], velocities[i], efforts[i], kps[i], kds[i]) && ok;
+            return ok;
+        }
+        bool ok = true;
+        std::unique_lock<std::mutex> lock(staging_mutex);
+        for (size_t i = 0; i < count; ++i)
+        {
+            auto it = slot_of.find(ids[i]);
+            if (it == slot_of.end())
+            {
+                ok = false;
+                continue;
+            }
+            float position = positions[i], velocity = velocities[i], effort = efforts[i];
+            if (!limit_terms(it->second, position, velocity, effort))
+            {
+                ok = false;
+                continue;
+            }
+            ok = stage_terms(lock, it->second, position, velocity, effort, kps[i], kds[i]) && ok;
+        }
+        return ok;
+    }
+
+    // Converts between motor and joint space for read_joints() and
+    // set_joint_*(), and enforces the table's joint limits on every position,
+    // velocity and effort command, whichever setter it comes through. Must be
+    // called while the worker is stopped and no setter is running.
+    bool set_calibration(const JointCalibration &calibration)
+    {
+        if (running())
+            return false;
+        joints = JointTransform(calibration, motor_ids);
+        std::lock_guard<std::mutex> lock(limits_mutex);
+        limiter = JointLimiter(calibration, joints, motor_ids);
+        return true;
+    }
+
+    // How often the joint limits of `id` clamped a command, and how many
+    // non-finite commands for it were refused.
+    bool limit_stats(int32_t id, JointLimitStats &out)
+    {
+        auto it = slot_of.find(id);
+        if (it == slot_of.end())
+            return false;
+        std::lock_guard<std::mutex> lock(limits_mutex);
+        out = limiter.stats(it->second);
+        return true;
+    }
+
+    // Latest feedback of every motor in joint space, in ids() order. Reads
+    // the worker's slots when it runs and the bridge otherwise. Returns false
+    // if any motor has no valid feedback. Fields left out by
+    // set_feedback_fields() come back as NaN.
+    bool read_joints(JointBuffer &out)
+    {
+        size_t count = motor_ids.size();
+        out.resize(count);
+        bool ok = true;
+        MotorFeedback value;
+        std::vector<MotorFeedback> direct;
+        if (!running())
+            read_feedback(direct);
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (direct.empty())
+                slots[i].load(value);
+            else
+                value = direct[i];
+            out.position[i] = value.position;
+            out.velocity[i] = value.velocity;
+            out.effort[i] = value.effort;
+            out.valid[i] = value.valid;
+            ok = ok && value.valid;
+        }
+        joints.position_to_joint(out.position.data(), out.position.data(), 0, count);
+        joints.velocity_to_joint(out.velocity.data(), out.velocity.data(), 0, count);
+        joints.effort_to_joint(out.effort.data(), out.effort.data(), 0, count);
+        return ok;
+    }
+
+    // Joint-space targets for every motor, in ids() order. Converted to motor
+    // space in blocks and staged under one lock while the worker runs.
+    bool set_joint_positions(const std::vector<float> &values)
+    {
+        return set_joints(POSITION, values);
+    }
+
+    bool set_joint_velocities(const std::vector<float> &values)
+    {
+        return set_joints(VELOCITY, values);
+    }
+
+    bool set_joint_efforts(const std::vector<float> &values)
+    {
+        return set_joints(EFFORT, values);
+    }
+
+    // Queues a command to take effect at monotonic time `time` (see
+    // monotonic_seconds()). The worker stages it on the tick closest to that
+    // time. Requires a running worker; pending entries are dropped by stop().
+    bool schedule_position(int32_t id, float value, double time)
+    {
+        return schedule(id, POSITION, value, time);
+    }
+
+    bool schedule_velocity(int32_t id, float value, double time)
+    {
+        return schedule(id, VELOCITY, value, time);
+    }
+
+    bool schedule_current(int32_t id, float value, double time)
+    {
+        return schedule(id, CURRENT, value, time);
+    }
+
+    bool schedule_effort(int32_t id, float value, double time)
+    {
+        return schedule(id, EFFORT, value, time);
+    }
+
+    // Schedules positions for several motors that take effect on the same tick.
+    bool schedule_positions(const std::vector<int32_t> &ids, const std::vector<float> &values, double time)
+    {
+        if (ids.size() != values.size() || !running())
+            return false;
+        std::vector<float> limited(values);
+        for (size_t i = 0; i < ids.size(); ++i)
+        {
+            if (!slot_of.count(ids[i]))
+                return false;
+        }
+        bool finite = true;
+        {
+            std::lock_guard<std::mutex> limits_lock(limits_mutex);
+            for (size_t i = 0; i < ids.size(); ++i)
+                finite = limiter.clamp(LimitKind::POSITION, slot_of.find(ids[i])->second, limited[i]) && finite;
+        }
+        if (!finite)
+            return false;
+        std::lock_guard<std::mutex> lock(schedule_mutex);
+        for (size_t i = 0; i < ids.size(); ++i)
+            scheduled.push({time, schedule_sequence++, ids[i], POSITION, limited[i]});
+        schedule_total += ids.size();
+        return true;
+    }
+
+    ScheduleStats schedule_stats()
+    {
+        std::lock_guard<std::mutex> lock(schedule_mutex);
+        ScheduleStats stats;
+        stats.scheduled = schedule_total;
+        stats.dispatched = schedule_dispatched;
+        stats.cancelled = schedule_cancelled;
+        stats.pending = scheduled.size();
+        stats.lateness_last = lateness_last;
+        stats.lateness_max = lateness_max;
+        stats.lateness_mean = schedule_dispatched ? lateness_sum / double(schedule_dispatched) : 0.0;
+        return stats;
+    }
+
+    // Keeps the last `capacity` feedback samples of every motor, stamped with
+    // monotonic_seconds(). Must be called before start().
+    bool enable_history(size_t capacity)
+    {
+        if (running())
+            return false;
+        history.clear();
+        for (size_t i = 0; i < motor_ids.size(); ++i)
+            history.push_back(std::make_unique<MotorHistory>(capacity));
+        return true;
+    }
+
+    // Feedback of motor `id` at monotonic time `time`, interpolated from the
+    // history. Lock-free; safe to call from any thread while the worker runs.
+    bool sample_at(int32_t id, double time, MotorSample &out) const
+    {
+        auto it = slot_of.find(id);
+        if (it == slot_of.end() || history.empty())
+            return false;
+        return history[it->second]->sample_at(time, out);
+    }
+
+    // Selects the estimator that fills the filtered_* fields of the snapshot.
+    // It runs once per feedback sample on the worker: with clock sync enabled
+    // only on fresh frames, stepped by the time between their timestamps.
+    // The Butterworth stages are designed for the worker rate; with clock sync
+    // they are redesigned for each motor's fitted frame period once it is
+    // known and whenever it moves by more than 10%, so the cutoff holds for a
+    // motor sending slower than the worker ticks. Must be called before start().
+    bool set_feedback_filter(const FilterConfig &config)
+    {
+        if (running())
+            return false;
+        filter_config = config;
+        return true;
+    }
+
+    // Reads every motor's feedback age each tick and fits a per-motor mapping
+    // from its frame cadence to the host clock over the last `window` frames.
+    // Must be called before start().
+    bool enable_clock_sync(size_t window)
+    {
+        if (running())
+            return false;
+        clocks.assign(motor_ids.size(), MotorClockSync(window));
+        clock_periods.assign(motor_ids.size(), 0.0);
+        clock_jitters.assign(motor_ids.size(), 0.0);
+        return true;
+    }
+
+    // Tracks feedback rate, inter-arrival jitter, gaps and estimated lost
+    // frames per motor over the last `window` seconds. Needs the feedback age,
+    // so clock sync is switched on if it is not already. Must be called
+    // before start().
+    bool enable_link_monitor(double window)
+    {
+        if (running())
+            return false;
+        if (clocks.empty())
+            enable_clock_sync(64);
+        std::lock_guard<std::mutex> lock(link_mutex);
+        monitors.assign(motor_ids.size(), LinkMonitor(window));
+        return true;
+    }
+
+    // Classifies every motor as live, stale or lost from its feedback age on
+    // each tick. A lost motor is taken over by a background thread that waits
+    // for its feedback to come back, then restores its last control mode and
+    // gains and re-enables it if it was enabled; meanwhile the worker keeps
+    // serving the other motors at the full rate. Turns on clock sync for the
+    // age. Must be called before start().
+    bool enable_health_monitor(HealthConfig config = HealthConfig())
+    {
+        if (running() || config.stale_after <= 0.0 || config.lost_after < config.stale_after)
+            return false;
+        if (clocks.empty())
+            enable_clock_sync(64);
+        health_config = config;
+        health.reset(new MotorHealthSlot[motor_ids.size()]);
+        return true;
+    }
+
+    MotorHealth health_of(int32_t id) const
+    {
+        auto it = slot_of.find(id);
+        if (it == slot_of.end() || !health)
+            return MotorHealth::LIVE;
+        return MotorHealth(health[it->second].state.load(std::memory_order_acquire));
+    }
+
+    bool health_stats(int32_t id, HealthStats &out) const
+    {
+        auto it = slot_of.find(id);
+        if (it == slot_of.end() || !health)
+            return false;
+        const MotorHealthSlot &slot = health[it->second];
+        out.state = MotorHealth(slot.state.load(std::memory_order_acquire));
+        out.losses = slot.losses.load(std::memory_order_relaxed);
+        out.recoveries = slot.recoveries.load(std::memory_order_relaxed);
+        out.failed_attempts = slot.failed_attempts.load(std::memory_order_relaxed);
+        return true;
+    }
+
+    bool link_stats(int32_t id, LinkStats &out)
+    {
+        auto it = slot_of.find(id);
+        std::lock_guard<std::mutex> lock(link_mutex);
+        if (it == slot_of.end() || monitors.empty())
+            return false;
+        out = monitors[it->second].stats(monotonic_seconds());
+        return true;
+    }
+
+    // Every counter of this manager in Prometheus text format, one series per
+    // line, per-motor series labelled with motor="<id>".
+    void write_metrics(std::ostream &out)
+    {
+        CommandStats commands = command_stats();
+        out << "fourier_command_writes_total " << commands.writes << '\n'
+            << "fourier_command_coalesced_total " << commands.coalesced << '\n'
+            << "fourier_command_flushed_total " << commands.flushed << '\n'
+            << "fourier_command_failed_total " << commands.failed << '\n';
+
+        QueueStats queue = queue_stats();
+        out << "fourier_queue_depth " << queue.depth << '\n'
+            << "fourier_queue_max_depth " << queue.max_depth << '\n'
+            << "fourier_queue_overflows_total " << queue.overflows << '\n'
+            << "fourier_queue_dropped_total{policy=\"oldest\"} " << queue.dropped_oldest << '\n'
+            << "fourier_queue_dropped_total{policy=\"newest\"} " << queue.dropped_newest << '\n'
+            << "fourier_queue_blocked_total " << queue.blocked << '\n'
+            << "fourier_queue_block_timeouts_total " << queue.timeouts << '\n'
+            << "fourier_queue_latency_seconds{stat=\"last\"} " << queue.latency_last << '\n'
+            << "fourier_queue_latency_seconds{stat=\"mean\"} " << queue.latency_mean << '\n'
+            << "fourier_queue_latency_seconds{stat=\"max\"} " << queue.latency_max << '\n';
+
+        IoStats io = io_stats();
+        out << "fourier_ticks_total " << io.ticks << '\n'
+            << "fourier_bridge_calls_total " << io.bridge_calls << '\n'
+            << "fourier_bridge_calls_last_tick " << io.last_tick_calls << '\n'
+            << "fourier_bridge_calls_max_tick " << io.max_tick_calls << '\n';
+
+        LatencyStats latency = latency_stats();
+        out << "fourier_wakeup_lateness_seconds{stat=\"last\"} " << latency.wakeup_last << '\n'
+            << "fourier_wakeup_lateness_seconds{stat=\"mean\"} " << latency.wakeup_mean << '\n'
+            << "fourier_wakeup_lateness_seconds{stat=\"max\"} " << latency.wakeup_max << '\n'
+            << "fourier_feedback_age_seconds{stat=\"last\"} " << latency.age_last << '\n'
+            << "fourier_feedback_age_seconds{stat=\"max\"} " << latency.age_max << '\n';
+
+        SkewStats skew = skew_stats();
+        out << "fourier_actuation_skew_seconds{stat=\"last\"} " << skew.last << '\n'
+            << "fourier_actuation_skew_seconds{stat=\"mean\"} " << skew.mean << '\n'
+            << "fourier_actuation_skew_seconds{stat=\"max\"} " << skew.max << '\n';
+
+        ScheduleStats schedule = schedule_stats();
+        out << "fourier_scheduled_total " << schedule.scheduled << '\n'
+            << "fourier_scheduled_dispatched_total " << schedule.dispatched << '\n'
+            << "fourier_scheduled_cancelled_total " << schedule.cancelled << '\n'
+            << "fourier_scheduled_pending " << schedule.pending << '\n'
+            << "fourier_schedule_lateness_seconds{stat=\"mean\"} " << schedule.lateness_mean << '\n'
+            << "fourier_schedule_lateness_seconds{stat=\"max\"} " << schedule.lateness_max << '\n';
+
+        uint64_t captured = 0, dropped = 0;
+        if (capture_stats(captured, dropped))
+            out << "fourier_capture_records_total " << captured << '\n'
+                << "fourier_capture_dropped_total " << dropped << '\n';
+
+        HealthStats state;
+        for (int32_t id : motor_ids)
+        {
+            if (!health_stats(id, state))
+                break;
+            out << "fourier_motor_health{motor=\"" << id << "\"} " << int(state.state) << '\n'
+                << "fourier_motor_losses_total{motor=\"" << id << "\"} " << state.losses << '\n'
+                << "fourier_motor_recoveries_total{motor=\"" << id << "\"} " << state.recoveries << '\n'
+                << "fourier_motor_failed_recoveries_total{motor=\"" << id << "\"} " << state.failed_attempts << '\n';
+        }
+
+        LinkStats link;
+        for (int32_t id : motor_ids)
+        {
+            if (!link_stats(id, link))
+                break;
+            out << "fourier_link_rate_hz{motor=\"" << id << "\"} " << link.rate_hz << '\n'
+                << "fourier_link_jitter_seconds{motor=\"" << id << "\"} " << link.jitter << '\n'
+                << "fourier_link_max_gap_seconds{motor=\"" << id << "\"} " << link.max_gap << '\n'
+                << "fourier_link_gaps{motor=\"" << id << "\"} " << link.gaps << '\n'
+                << "fourier_link_lost_frames{motor=\"" << id << "\"} " << link.lost << '\n'
+                << "fourier_link_silence_seconds{motor=\"" << id << "\"} " << link.silence << '\n';
+        }
+    }
+
+    // Fitted send period and residual jitter (seconds) of motor `id`.
+    bool clock_stats(int32_t id, double &period, double &jitter)
+    {
+        auto it = slot_of.find(id);
+        if (it == slot_of.end() || clocks.empty())
+            return false;
+        std::lock_guard<std::mutex> lock(clock_mutex);
+        period = clock_periods[it->second];
+        jitter = clock_jitters[it->second];
+        return true;
+    }
+
+    // Motors of this manager with the last mode and gains set through it.
+    MotorTopology topology(const std::string &interface = std::string())
+    {
+        MotorTopology result;
+        std::lock_guard<std::mutex> lock(config_mutex);
+        result.motors = configs;
+        for (auto &motor : result.motors)
+            motor.interface = interface;
+        return result;
+    }
+
+    // Restores a cached topology after a single wait for every motor's first
+    // frame. Motors still in their cached control mode are left untouched;
+    // the others get their cached mode and gains again. Returns false if a
+    // motor did not answer within `timeout` or could not be reconfigured, in
+    // which case the caller should fall back to a full setup.
+    bool warm_start(const MotorTopology &cache, float timeout)
+    {
+        if (!wait_for_first_messages(timeout))
+            return false;
+        bool ok = true;
+        for (const auto &motor : cache.motors)
+        {
+            if (!config_for(motor.id))
+                continue;
+            if (!motor.control_mode.empty() && get_control_mode(motor.id) != motor.control_mode)
+                ok = restore(motor) && ok;
+            else
+                remember(motor);
+        }
+        return ok;
+    }
+
+    // Records every bridge exchange of this manager, plus API calls that were
+    // only staged, to a pcap file written from a background thread. Must be
+    // called while the worker is stopped.
+    bool enable_capture(const std::string &path, size_t queue_capacity = 1 << 16)
+    {
+        if (running())
+            return false;
+        std::unique_ptr<PcapCapture> opened(new PcapCapture(path, queue_capacity));
+        if (!opened->is_open())
+            return false;
+        capture = std::move(opened);
+        return true;
+    }
+
+    void disable_capture()
+    {
+        if (!running())
+            capture.reset();
+    }
+
+    // Records written and records dropped because the capture queue was full.
+    bool capture_stats(uint64_t &captured, uint64_t &dropped) const
+    {
+        if (!capture)
+            return false;
+        captured = capture->captured_count();
+        dropped = capture->dropped_count();
+        return true;
+    }
+
+    // Called on the worker with every tick's feedback before it is published.
+    // Must be cheap and must not call back into the manager's blocking API or
+    // into set_tick_callback(). May be replaced or cleared (nullptr) while the
+    // worker runs; on return the previous callback is not running and is never
+    // called again.
+    void set_tick_callback(std::function<void(const std::vector<MotorFeedback> &)> callback)
+    {
+        std::lock_guard<std::mutex> lock(callback_mutex);
+        tick_callback = std::move(callback);
+    }
+
+    // In synchronous mode a flush sends one command type to all motors back to
+    // back (all positions, then all velocities, ...) instead of motor by motor,
+    // which keeps the actuation skew between joints to one burst per type.
+    void set_synchronous_flush(bool enabled)
+    {
+        synchronous_flush.store(enabled, std::memory_order_relaxed);
+    }
+
+    void set_overflow_policy(OverflowPolicy policy, double block_timeout = 0.01)
+    {
+        overflow_policy.store(policy, std::memory_order_relaxed);
+        overflow_timeout.store(block_timeout, std::memory_order_relaxed);
+    }
+
+    QueueStats queue_stats() const
+    {
+        QueueStats stats;
+        stats.depth = queue_depth.load(std::memory_order_relaxed);
+        stats.max_depth = queue_max_depth.load(std::memory_order_relaxed);
+        stats.overflows = queue_overflows.load(std::memory_order_relaxed);
+        stats.dropped_oldest = command_coalesced.load(std::memory_order_relaxed);
+        stats.dropped_newest = queue_dropped_newest.load(std::memory_order_relaxed);
+        stats.blocked = queue_blocked.load(std::memory_order_relaxed);
+        stats.timeouts = queue_timeouts.load(std::memory_order_relaxed);
+        stats.sent = queue_sent.load(std::memory_order_relaxed);
+        stats.latency_last = queue_latency_last.load(std::memory_order_relaxed);
+        stats.latency_max = queue_latency_max.load(std::memory_order_relaxed);
+        stats.latency_mean = stats.sent ? queue_latency_sum.load(std::memory_order_relaxed) / double(stats.sent) : 0.0;
+        return stats;
+    }
+
+    SkewStats skew_stats() const
+    {
+        SkewStats stats;
+        stats.flushes = skew_flushes.load(std::memory_order_relaxed);
+        stats.last = skew_last.load(std::memory_order_relaxed);
+        stats.max = skew_max.load(std::memory_order_relaxed);
+        stats.mean = stats.flushes ? skew_sum.load(std::memory_order_relaxed) / double(stats.flushes) : 0.0;
+        return stats;
+    }
+
+    // Selects which FeedbackField values read_feedback() and the worker fetch.
+    // Every field is one bridge call per motor, so a controller that only
+    // needs positions cuts its per-tick transport work to a quarter. Fields
+    // not read are NaN everywhere feedback is published (snapshots,
+    // feedback_of(), read_joints(), history), and MotorFeedback::fields tells
+    // which were read. The filters need FEEDBACK_POSITION.
+    void set_feedback_fields(uint8_t fields)
+    {
+        feedback_fields.store(fields, std::memory_order_relaxed);
+    }
+
+    LatencyStats latency_stats() const
+    {
+        LatencyStats stats;
+        stats.ticks = wakeup_ticks.load(std::memory_order_relaxed);
+        stats.wakeup_last = wakeup_last.load(std::memory_order_relaxed);
+        stats.wakeup_max = wakeup_max.load(std::memory_order_relaxed);
+        stats.wakeup_mean = stats.ticks ? wakeup_sum.load(std::memory_order_relaxed) / double(stats.ticks) : 0.0;
+        stats.age_last = age_last.load(std::memory_order_relaxed);
+        stats.age_max = age_max.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+    IoStats io_stats() const
+    {
+        IoStats stats;
+        stats.ticks = io_ticks.load(std::memory_order_relaxed);
+        stats.bridge_calls = bridge_calls.load(std::memory_order_relaxed);
+        stats.last_tick_calls = io_last_tick_calls.load(std::memory_order_relaxed);
+        stats.max_tick_calls = io_max_tick_calls.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+    CommandStats command_stats() const
+    {
+        CommandStats stats;
+        stats.writes = command_writes.load(std::memory_order_relaxed);
+        stats.coalesced = command_coalesced.load(std::memory_order_relaxed);
+        stats.flushed = command_flushed.load(std::memory_order_relaxed);
+        stats.failed = command_failed.load(std::memory_order_relaxed);
+        return stats;
+    }
+
 private:
+    void trace(CaptureDirection direction, const char *call, int32_t id, bool ok,
+               std::initializer_list<float> values = {})
+    {
+        if (capture)
+            capture->record(direction, call, id, ok, values);
+    }
+
+    MotorConfig *config_for(int32_t id)
+    {
+        auto it = slot_of.find(id);
+        return it == slot_of.end() ? nullptr : &configs[it->second];
+    }
+
+    bool restore(const MotorConfig &motor)
+    {
+        bool ok = set_control_mode(motor.id, motor.control_mode);
+        if (motor.has_pid_gain)
+            ok = set_motor_pid_gain(motor.id, motor.position_kp, motor.velocity_kp, motor.velocity_ki) && ok;
+        if (motor.has_pd_gain)
+            ok = set_control_pd_gain(motor.id, motor.kp, motor.kd) && ok;
+        return ok;
+    }
+
+    void remember(const MotorConfig &motor)
+    {
+        MotorConfig *config = config_for(motor.id);
+        std::lock_guard<std::mutex> lock(config_mutex);
+        *config = motor;
+        config->interface.clear();
+    }
+
+    enum CommandKind : uint8_t
+    {
+        POSITION,
+        VELOCITY,
+        CURRENT,
+        EFFORT,
+        COMMAND_KINDS,
+    };
+
+    static constexpr const char *command_names[COMMAND_KINDS] = {
+        "set_position",
+        "set_velocity",
+        "set_current",
+        "set_effort",
+    };
+
+    static constexpr uint8_t GAIN_PENDING = 1u << COMMAND_KINDS;
+
+    struct StagedCommand
+    {
+        float value[COMMAND_KINDS] = {};
+        float kp = 0.0f;
+        float kd = 0.0f;
+        uint8_t pending = 0;
+        // monotonic_seconds() of the latest write, per kind and for the gains.
+        double enqueued[COMMAND_KINDS] = {};
+        double gains_enqueued = 0.0;
+    };
+
+    struct ScheduledCommand
+    {
+        double time;
+        uint64_t sequence;
+        int32_t id;
+        CommandKind kind;
+        float value;
+
+        bool operator>(const ScheduledCommand &other) const
+        {
+            return time != other.time ? time > other.time : sequence > other.sequence;
+        }
+    };
+
+    bool schedule(int32_t id, CommandKind kind, float value, double time)
+    {
+        if (!running() || !slot_of.count(id))
+            return false;
+        if (!limit(id, kind, value))
+            return false;
+        std::lock_guard<std::mutex> lock(schedule_mutex);
+        scheduled.push({time, schedule_sequence++, id, kind, value});
+        ++schedule_total;
+        return true;
+    }
+
+    struct PendingGainTable
+    {
+        uint64_t tick;
+        GainTable table;
+        std::promise<GainTableResult> done;
+    };
+
+    GainTableResult apply_gains(const GainTable &table)
+    {
+        GainTableResult result;
+        double start = monotonic_seconds();
+        for (const auto &entry : table)
+        {
+            if (entry.has_pid_gain)
+            {
+                if (set_motor_pid_gain(entry.id, entry.position_kp, entry.velocity_kp, entry.velocity_ki))
+                    ++result.acknowledged;
+                else
+                    ++result.failed;
+            }
+            if (entry.has_pd_gain)
+            {
+                if (set_control_pd_gain(entry.id, entry.kp, entry.kd))
+                    ++result.acknowledged;
+                else
+                    ++result.failed;
+            }
+        }
+        result.upload_time = monotonic_seconds() - start;
+        return result;
+    }
+
+    // Uploads every gain table due at this tick, in tick order.
+    void dispatch_gains()
+    {
+        uint64_t tick = current_tick();
+        std::vector<PendingGainTable> due;
+        {
+            std::lock_guard<std::mutex> lock(gain_mutex);
+            if (pending_gains.empty())
+                return;
+            for (size_t i = 0; i < pending_gains.size();)
+            {
+                if (pending_gains[i].tick <= tick)
+                {
+                    due.push_back(std::move(pending_gains[i]));
+                    pending_gains.erase(pending_gains.begin() + i);
+                }
+                else
+                    ++i;
+            }
+        }
+        std::stable_sort(due.begin(), due.end(), [](const PendingGainTable &a, const PendingGainTable &b)
+                         { return a.tick < b.tick; });
+        for (auto &entry : due)
+        {
+            GainTableResult result = apply_gains(entry.table);
+            result.requested_tick = entry.tick;
+            result.applied_tick = tick;
+            entry.done.set_value(result);
+        }
+    }
+
+    void cancel_gains()
+    {
+        std::lock_guard<std::mutex> lock(gain_mutex);
+        for (auto &entry : pending_gains)
+        {
+            GainTableResult result;
+            result.requested_tick = entry.tick;
+            result.cancelled = true;
+            entry.done.set_value(result);
+        }
+        pending_gains.clear();
+    }
+
+    // Stages every scheduled command whose deadline is nearer to this tick
+    // than to the next one.
+    void dispatch_scheduled()
+    {
+        double now = monotonic_seconds();
+        double horizon = now + 0.5 * tick_period;
+        std::lock_guard<std::mutex> lock(schedule_mutex);
+        while (!scheduled.empty() && scheduled.top().time <= horizon)
+        {
+            const ScheduledCommand &entry = scheduled.top();
+            if (!stage(entry.id, entry.kind, entry.value, false))
+            {
+                ++schedule_cancelled;
+                scheduled.pop();
+                continue;
+            }
+            double lateness = now - entry.time;
+            lateness_last = lateness;
+            lateness_sum += lateness;
+            if (lateness > lateness_max)
+                lateness_max = lateness;
+            ++schedule_dispatched;
+            scheduled.pop();
+        }
+    }
+
+    static size_t bit_count(uint8_t bits)
+    {
+        size_t count = 0;
+        for (; bits; bits &= uint8_t(bits - 1))
+            ++count;
+        return count;
+    }
+
+    // `lock` holds staging_mutex. Applies the overflow policy when one of
+    // `bits` is still pending for motor `index`; false means the new command
+    // is refused. The worker itself never blocks and replaces instead.
+    bool make_room(std::unique_lock<std::mutex> &lock, size_t index, uint8_t bits, bool may_block)
+    {
+        if (!(staging[active_staging][index].pending & bits))
+            return true;
+        queue_overflows.fetch_add(1, std::memory_order_relaxed);
+        OverflowPolicy policy = overflow_policy.load(std::memory_order_relaxed);
+        if (policy == OverflowPolicy::DROP_NEWEST)
+        {
+            queue_dropped_newest.fetch_add(bit_count(bits), std::memory_order_relaxed);
+            return false;
+        }
+        if (policy != OverflowPolicy::BLOCK || !may_block)
+            return true;
+        queue_blocked.fetch_add(1, std::memory_order_relaxed);
+        auto timeout = std::chrono::duration<double>(overflow_timeout.load(std::memory_order_relaxed));
+        bool room = staging_drained.wait_for(lock, timeout, [&]
+                                             { return !running() || !(staging[active_staging][index].pending & bits); });
+        if (!room)
+        {
+            queue_timeouts.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        return running();
+    }
+
+    static LimitKind limit_kind(CommandKind kind)
+    {
+        return kind == POSITION ? LimitKind::POSITION : kind == VELOCITY ? LimitKind::VELOCITY : LimitKind::EFFORT;
+    }
+
+    // Clamps `value` to the joint limits of `id`. A non-finite value is
+    // counted and refused; the setter then returns false and whatever was
+    // staged before stays staged.
+    bool limit(int32_t id, CommandKind kind, float &value)
+    {
+        bool finite = std::isfinite(value);
+        if (finite && (kind == CURRENT || limiter.empty()))
+            return true;
+        auto it = slot_of.find(id);
+        if (it == slot_of.end())
+            return finite;
+        std::lock_guard<std::mutex> lock(limits_mutex);
+        if (kind != CURRENT)
+            return limiter.clamp(limit_kind(kind), it->second, value);
+        limiter.reject(it->second);
+        return false;
+    }
+
+    bool limit_terms(size_t index, float &position, float &velocity, float &effort)
+    {
+        bool finite = std::isfinite(position) && std::isfinite(velocity) && std::isfinite(effort);
+        if (finite && limiter.empty())
+            return true;
+        std::lock_guard<std::mutex> lock(limits_mutex);
+        bool ok = limiter.clamp(LimitKind::POSITION, index, position);
+        ok = limiter.clamp(LimitKind::VELOCITY, index, velocity) && ok;
+        return limiter.clamp(LimitKind::EFFORT, index, effort) && ok;
+    }
+
+    void joints_to_motor(CommandKind kind, const float *in, float *out, size_t first, size_t count) const
+    {
+        if (kind == POSITION)
+            joints.position_to_motor(in, out, first, count);
+        else if (kind == VELOCITY)
+            joints.velocity_to_motor(in, out, first, count);
+        else
+            joints.effort_to_motor(in, out, first, count);
+    }
+
+    bool set_joints(CommandKind kind, const std::vector<float> &values)
+    {
+        const size_t block = 64;
+        size_t count = motor_ids.size();
+        if (values.size() != count)
+            return false;
+        float motor[block];
+        bool ok = true;
+        std::unique_lock<std::mutex> lock(staging_mutex, std::defer_lock);
+        bool staged = running();
+        if (staged)
+            lock.lock();
+        for (size_t first = 0; first < count; first += block)
+        {
+            size_t n = count - first < block ? count - first : block;
+            joints_to_motor(kind, values.data() + first, motor, first, n);
+            {
+                std::lock_guard<std::mutex> limits_lock(limits_mutex);
+                limiter.clamp(limit_kind(kind), motor, first, n);
+            }
+            for (size_t i = 0; i < n; ++i)
+            {
+                if (!std::isfinite(motor[i]))
+                    ok = false;
+                else if (staged)
+                    ok = stage_locked(lock, first + i, kind, motor[i], true) && ok;
+                else
+                    ok = send_command(motor_ids[first + i], kind, motor[i]) && ok;
+            }
+        }
+        return ok;
+    }
+
+    // Caller holds staging_mutex.
+    void note_staged(uint8_t added)
+    {
+        queue_pending += bit_count(added);
+        queue_depth.store(queue_pending, std::memory_order_relaxed);
+        if (queue_pending > queue_max_depth.load(std::memory_order_relaxed))
+            queue_max_depth.store(queue_pending, std::memory_order_relaxed);
+    }
+
+    // Caller holds staging_mutex; refused once stop() began, like stage_locked().
+    bool stage_terms(std::unique_lock<std::mutex> &lock, size_t index, float position, float velocity,
+                     float effort, float kp, float kd)
+    {
+        const uint8_t bits = uint8_t((1u << POSITION) | (1u << VELOCITY) | (1u << EFFORT) | GAIN_PENDING);
+        if (!running() || !make_room(lock, index, bits, true))
+        {
+            trace(CaptureDirection::API, "set_command", motor_ids[index], false, {position, velocity, effort, kp});
+            return false;
+        }
+        StagedCommand &slot = staging[active_staging][index];
+        uint8_t overwritten = slot.pending & bits;
+        command_coalesced.fetch_add(bit_count(overwritten), std::memory_order_relaxed);
+        note_staged(uint8_t(bits & ~overwritten));
+        double now = monotonic_seconds();
+        slot.value[POSITION] = position;
+        slot.value[VELOCITY] = velocity;
+        slot.value[EFFORT] = effort;
+        slot.enqueued[POSITION] = slot.enqueued[VELOCITY] = slot.enqueued[EFFORT] = now;
+        slot.kp = kp;
+        slot.kd = kd;
+        slot.gains_enqueued = now;
+        slot.pending |= bits;
+        command_writes.fetch_add(4, std::memory_order_relaxed);
+        trace(CaptureDirection::API, "set_command", motor_ids[index], true, {position, velocity, effort, kp});
+        return true;
+    }
+
+    // Sends PD gains unless the motor already has exactly these.
+    bool send_gains(size_t index, float kp, float kd)
+    {
+        {
+            std::lock_guard<std::mutex> lock(config_mutex);
+            const MotorConfig &config = configs[index];
+            if (config.has_pd_gain && config.kp == kp && config.kd == kd)
+                return true;
+        }
+        return set_control_pd_gain(motor_ids[index], kp, kd);
+    }
+
+    bool stage(int32_t id, CommandKind kind, float value, bool may_block = true)
+    {
+        auto it = slot_of.find(id);
+        if (it == slot_of.end())
+            return false;
+        std::unique_lock<std::mutex> lock(staging_mutex);
+        return stage_locked(lock, it->second, kind, value, may_block);
+    }
+
+    // Caller holds staging_mutex. running() is checked under it: stop()
+    // clears the flag before its final flush takes the lock, so a setter that
+    // loses that race is refused instead of leaving a command staged for the
+    // next start().
+    bool stage_locked(std::unique_lock<std::mutex> &lock, size_t index, CommandKind kind, float value, bool may_block)
+    {
+        int32_t id = motor_ids[index];
+        uint8_t bit = uint8_t(1u << kind);
+        if (!running() || !make_room(lock, index, bit, may_block))
+        {
+            trace(CaptureDirection::API, command_names[kind], id, false, {value});
+            return false;
+        }
+        StagedCommand &slot = staging[active_staging][index];
+        if (slot.pending & bit)
+            command_coalesced.fetch_add(1, std::memory_order_relaxed);
+        else
+            note_staged(bit);
+        slot.value[kind] = value;
+        slot.enqueued[kind] = monotonic_seconds();
+        slot.pending |= bit;
+        command_writes.fetch_add(1, std::memory_order_relaxed);
+        trace(CaptureDirection::API, command_names[kind], id, true, {value});
+        return true;
+    }
+
+    bool send_command(int32_t id, CommandKind kind, float value)
+    {
+        bool ok = false;
+        switch (kind)
+        {
+        case POSITION:
+            ok = manager->cxx_set_position(id, value);
+            break;
+        case VELOCITY:
+            ok = manager->cxx_set_velocity(id, value);
+            break;
+        case CURRENT:
+            ok = manager->cxx_set_current(id, value);
+            break;
+        case EFFORT:
+            ok = manager->cxx_set_effort(id, value);
+            break;
+        default:
+            break;
+        }
+        bridge_calls.fetch_add(1, std::memory_order_relaxed);
+        trace(CaptureDirection::TX, command_names[kind], id, ok, {value});
+        return ok;
+    }
+
+    // Swaps the staging buffers so setters keep writing while the previous
+    // tick's commands go out without holding the lock.
+    void flush_commands()
+    {
+        size_t ready;
+        {
+            std::lock_guard<std::mutex> lock(staging_mutex);
+            ready = active_staging;
+            active_staging ^= 1;
+            queue_pending = 0;
+            queue_depth.store(0, std::memory_order_relaxed);
+        }
+        staging_drained.notify_all();
+        std::vector<StagedCommand> &buffer = staging[ready];
+        for (size_t i = 0; i < buffer.size(); ++i)
+        {
+            if (!(buffer[i].pending & GAIN_PENDING))
+                continue;
+            if (send_gains(i, buffer[i].kp, buffer[i].kd))
+                command_flushed.fetch_add(1, std::memory_order_relaxed);
+            else
+                command_failed.fetch_add(1, std::memory_order_relaxed);
+            record_queue_latency(monotonic_seconds() - buffer[i].gains_enqueued);
+        }
+        double first = 0.0;
+        size_t sent = 0;
+        if (synchronous_flush.load(std::memory_order_relaxed))
+        {
+            for (uint8_t kind = 0; kind < COMMAND_KINDS; ++kind)
+            {
+                for (size_t i = 0; i < buffer.size(); ++i)
+                {
+                    if (buffer[i].pending & (1u << kind))
+                        flush_one(i, CommandKind(kind), buffer[i], first, sent);
+                }
+            }
+            for (auto &slot : buffer)
+                slot.pending = 0;
+        }
+        else
+        {
+            for (size_t i = 0; i < buffer.size(); ++i)
+            {
+                StagedCommand &slot = buffer[i];
+                if (!slot.pending)
+                    continue;
+                for (uint8_t kind = 0; kind < COMMAND_KINDS; ++kind)
+                {
+                    if (slot.pending & (1u << kind))
+                        flush_one(i, CommandKind(kind), slot, first, sent);
+                }
+                slot.pending = 0;
+            }
+        }
+        if (sent > 1)
+            record_skew(monotonic_seconds() - first);
+    }
+
+    void flush_one(size_t index, CommandKind kind, const StagedCommand &slot, double &first, size_t &sent)
+    {
+        if (sent++ == 0)
+            first = monotonic_seconds();
+        if (send_command(motor_ids[index], kind, slot.value[kind]))
+            command_flushed.fetch_add(1, std::memory_order_relaxed);
+        else
+            command_failed.fetch_add(1, std::memory_order_relaxed);
+        record_queue_latency(monotonic_seconds() - slot.enqueued[kind]);
+    }
+
+    void record_queue_latency(double latency)
+    {
+        uint64_t sent = queue_sent.load(std::memory_order_relaxed) + 1;
+        queue_latency_last.store(latency, std::memory_order_relaxed);
+        queue_latency_sum.store(queue_latency_sum.load(std::memory_order_relaxed) + latency, std::memory_order_relaxed);
+        if (latency > queue_latency_max.load(std::memory_order_relaxed))
+            queue_latency_max.store(latency, std::memory_order_relaxed);
+        queue_sent.store(sent, std::memory_order_relaxed);
+    }
+
+    void record_io(uint64_t calls)
+    {
+        io_last_tick_calls.store(calls, std::memory_order_relaxed);
+        if (calls > io_max_tick_calls.load(std::memory_order_relaxed))
+            io_max_tick_calls.store(calls, std::memory_order_relaxed);
+        io_ticks.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void record_skew(double skew)
+    {
+        uint64_t flushes = skew_flushes.load(std::memory_order_relaxed) + 1;
+        skew_last.store(skew, std::memory_order_relaxed);
+        skew_sum.store(skew_sum.load(std::memory_order_relaxed) + skew, std::memory_order_relaxed);
+        if (skew > skew_max.load(std::memory_order_relaxed))
+            skew_max.store(skew, std::memory_order_relaxed);
+        skew_flushes.store(flushes, std::memory_order_relaxed);
+    }
+
+    void tick(std::vector<MotorFeedback> &buffer)
+    {
+        uint64_t calls_before = bridge_calls.load(std::memory_order_relaxed);
+        dispatch_gains();
+        dispatch_scheduled();
+        flush_commands();
+        double stamp = monotonic_seconds();
+        read_feedback(buffer);
+        stamp_feedback(buffer, stamp);
+        if (health)
+            update_health(buffer);
+        apply_filters(buffer);
+        if (!history.empty())
+            record_history(buffer);
+        {
+            std::lock_guard<std::mutex> lock(callback_mutex);
+            if (tick_callback)
+                tick_callback(buffer);
+        }
+        for (size_t i = 0; i < buffer.size(); ++i)
+            slots[i].store(buffer[i]);
+        snapshots.publish(buffer, stamp);
+        record_io(bridge_calls.load(std::memory_order_relaxed) - calls_before);
+        if (clocks.empty())
+            return;
+        std::lock_guard<std::mutex> lock(clock_mutex);
+        for (size_t i = 0; i < clocks.size(); ++i)
+        {
+            clock_periods[i] = clocks[i].frame_period();
+            clock_jitters[i] = clocks[i].jitter();
+        }
+    }
+
+    void stamp_feedback(std::vector<MotorFeedback> &buffer, double stamp)
+    {
+        double age_sum = 0.0;
+        size_t age_count = 0;
+        arrivals.assign(buffer.size(), -1.0);
+        for (size_t i = 0; i < buffer.size(); ++i)
+        {
+            MotorFeedback &slot = buffer[i];
+            slot.timestamp = stamp;
+            slot.timestamp_uncertainty = 0.0;
+            slot.age = 0.0;
+            slot.fresh = slot.valid;
+            if (clocks.empty() || !slot.valid)
+                continue;
+            double read_time = monotonic_seconds();
+            double age = 0.0;
+            bridge_calls.fetch_add(1, std::memory_order_relaxed);
+            if (!parse_motor_age(std::string(manager->cxx_get_motor_state(slot.id)), age))
+                continue;
+            slot.age = age;
+            age_sum += age;
+            ++age_count;
+            MotorClockSync &clock = clocks[i];
+            slot.fresh = clock.observe(read_time, age);
+            slot.timestamp = clock.timestamp();
+            slot.timestamp_uncertainty = clock.uncertainty();
+            if (slot.fresh)
+                arrivals[i] = read_time - age;
+        }
+        observe_links();
+        if (age_count > 0)
+        {
+            double mean_age = age_sum / double(age_count);
+            age_last.store(mean_age, std::memory_order_relaxed);
+            if (mean_age > age_max.load(std::memory_order_relaxed))
+                age_max.store(mean_age, std::memory_order_relaxed);
+        }
+    }
+
+    void update_health(std::vector<MotorFeedback> &buffer)
+    {
+        bool lost = false;
+        for (size_t i = 0; i < buffer.size(); ++i)
+        {
+            MotorFeedback &slot = buffer[i];
+            MotorHealthSlot &state = health[i];
+            uint8_t current = state.state.load(std::memory_order_acquire);
+            // LOST and RECOVERING belong to the recovery thread from here on.
+            if (current == uint8_t(MotorHealth::LIVE) || current == uint8_t(MotorHealth::STALE))
+            {
+                MotorHealth next = MotorHealth::LIVE;
+                if (!slot.valid || slot.age > health_config.lost_after)
+                    next = MotorHealth::LOST;
+                else if (slot.age > health_config.stale_after)
+                    next = MotorHealth::STALE;
+                if (uint8_t(next) != current)
+                {
+                    if (next == MotorHealth::LOST)
+                    {
+                        state.losses.fetch_add(1, std::memory_order_relaxed);
+                        state.next_retry = 0.0;
+                        lost = true;
+                    }
+                    state.state.store(uint8_t(next), std::memory_order_release);
+                    current = uint8_t(next);
+                }
+            }
+            slot.health = MotorHealth(current);
+        }
+        if (!lost)
+            return;
+        {
+            std::lock_guard<std::mutex> lock(recovery_mutex);
+            recovery_pending = true;
+        }
+        recovery_wakeup.notify_one();
+    }
+
+    void start_recovery()
+    {
+        if (!health)
+            return;
+        recovery_running = true;
+        recovery = std::thread([this]
+                               { run_recovery(); });
+    }
+
+    void stop_recovery()
+    {
+        if (!recovery.joinable())
+            return;
+        {
+            std::lock_guard<std::mutex> lock(recovery_mutex);
+            recovery_running = false;
+        }
+        recovery_wakeup.notify_one();
+        recovery.join();
+    }
+
+    void run_recovery()
+    {
+        auto interval = std::chrono::duration<double>(health_config.retry_interval);
+        std::unique_lock<std::mutex> lock(recovery_mutex);
+        while (recovery_running)
+        {
+            recovery_wakeup.wait_for(lock, interval, [this]
+                                     { return recovery_pending || !recovery_running; });
+            if (!recovery_running)
+                break;
+            recovery_pending = false;
+            lock.unlock();
+            for (size_t i = 0; i < motor_ids.size(); ++i)
+            {
+                if (health[i].state.load(std::memory_order_acquire) == uint8_t(MotorHealth::LOST) &&
+                    monotonic_seconds() >= health[i].next_retry)
+                    recover(i);
+            }
+            lock.lock();
+        }
+    }
+
+    // Blocking bridge calls for one lost motor, run off the worker.
+    void recover(size_t i)
+    {
+        MotorHealthSlot &state = health[i];
+        int32_t id = motor_ids[i];
+        state.state.store(uint8_t(MotorHealth::RECOVERING), std::memory_order_release);
+
+        bool ok = false;
+        try
+        {
+            double age = 0.0;
+            ok = parse_motor_age(std::string(manager->cxx_get_motor_state(id)), age) &&
+                 age <= health_config.stale_after;
+        }
+        catch (const rust::Error &)
+        {
+        }
+
+        if (ok)
+        {
+            MotorConfig config;
+            bool was_enabled = false;
+            {
+                std::lock_guard<std::mutex> lock(config_mutex);
+                config = configs[i];
+                was_enabled = enabled_motors[i];
+            }
+            if (!config.control_mode.empty())
+                ok = restore(config);
+            if (ok && was_enabled)
+                ok = enable(id);
+        }
+
+        if (ok)
+        {
+            state.recoveries.fetch_add(1, std::memory_order_relaxed);
+            state.state.store(uint8_t(MotorHealth::LIVE), std::memory_order_release);
+        }
+        else
+        {
+            state.failed_attempts.fetch_add(1, std::memory_order_relaxed);
+            state.next_retry = monotonic_seconds() + health_config.retry_interval;
+            state.state.store(uint8_t(MotorHealth::LOST), std::memory_order_release);
+        }
+    }
+
+    void remember_enabled(int32_t id, bool enabled)
+    {
+        auto it = slot_of.find(id);
+        if (it == slot_of.end())
+            return;
+        std::lock_guard<std::mutex> lock(config_mutex);
+        enabled_motors[it->second] = enabled;
+    }
+
+    void observe_links()
+    {
+        std::lock_guard<std::mutex> lock(link_mutex);
+        if (monitors.empty())
+            return;
+        for (size_t i = 0; i < arrivals.size(); ++i)
+        {
+            if (arrivals[i] >= 0.0)
+                monitors[i].observe(arrivals[i], clocks[i].frame_period());
+        }
+    }
+
+    // Repeated frames carry no new measurement, so they only republish the
+    // filter's last estimate.
+    void apply_filters(std::vector<MotorFeedback> &buffer)
+    {
+        for (size_t i = 0; i < buffer.size(); ++i)
+        {
+            MotorFeedback &slot = buffer[i];
+            MotorStateFilter &filter = filters[i];
+            if (!clocks.empty() && filter_config.kind == FeedbackFilter::BUTTERWORTH)
+            {
+                // Fresh frames arrive at the slower of the motor and the worker.
+                double period = std::max(clocks[i].frame_period(), tick_period);
+                float rate = clocks[i].frame_period() > 0.0 ? float(1.0 / period) : 0.0f;
+                if (rate > 0.0f && std::fabs(rate - filter.sample_rate()) > 0.1f * filter.sample_rate())
+                    filter.set_sample_rate(rate);
+            }
+            if (slot.valid && slot.fresh && (slot.fields & FEEDBACK_POSITION))
+            {
+                double &previous = filter_stamps[i];
+                float dt = previous > 0.0 ? float(slot.timestamp - previous) : 0.0f;
+                filter.update(slot.position, slot.velocity, dt);
+                previous = slot.timestamp;
+            }
+            slot.filtered_position = filter.position;
+            slot.filtered_velocity = filter.velocity;
+            slot.filtered_acceleration = filter.acceleration;
+        }
+    }
+
+    void record_history(const std::vector<MotorFeedback> &buffer)
+    {
+        for (size_t i = 0; i < buffer.size(); ++i)
+        {
+            const MotorFeedback &slot = buffer[i];
+            if (!slot.valid || !slot.fresh)
+                continue;
+            MotorSample previous;
+            if (history[i]->latest(previous) && previous.time >= slot.timestamp)
+                continue;
+            MotorSample sample;
+            sample.time = slot.timestamp;
+            sample.position = slot.position;
+            sample.velocity = slot.velocity;
+            sample.current = slot.current;
+            sample.effort = slot.effort;
+            history[i]->push(sample);
+        }
+    }
+
+    void run(std::chrono::steady_clock::duration period)
+    {
+        std::vector<MotorFeedback> buffer(motor_ids.size());
+        auto next = std::chrono::steady_clock::now();
+        while (worker_running.load(std::memory_order_acquire))
+        {
+            tick(buffer);
+            next += period;
+            auto now = std::chrono::steady_clock::now();
+            if (next < now)
+                next = now;
+            std::this_thread::sleep_until(next);
+            record_wakeup(std::chrono::duration<double>(std::chrono::steady_clock::now() - next).count());
+        }
+    }
+
+    bool prepare_start(float rate_hz)
+    {
+        if (rate_hz <= 0.0f || worker.joinable() || io_executor)
+            return false;
+        for (auto &filter : filters)
+            filter.configure(filter_config, rate_hz);
+        filter_stamps.assign(motor_ids.size(), 0.0);
+        tick_period = 1.0 / rate_hz;
+        executor_buffer.assign(motor_ids.size(), MotorFeedback());
+        worker_running.store(true, std::memory_order_release);
+        return true;
+    }
+
+    void record_wakeup(double lateness)
+    {
+        uint64_t ticks = wakeup_ticks.load(std::memory_order_relaxed) + 1;
+        wakeup_last.store(lateness, std::memory_order_relaxed);
+        wakeup_sum.store(wakeup_sum.load(std::memory_order_relaxed) + lateness, std::memory_order_relaxed);
+        if (lateness > wakeup_max.load(std::memory_order_relaxed))
+            wakeup_max.store(lateness, std::memory_order_relaxed);
+        wakeup_ticks.store(ticks, std::memory_order_relaxed);
+    }
+
     rust::Box<MotorManagerSync> manager;
-};
\ No newline at end of file
+    std::vector<int32_t> motor_ids;
+    std::unordered_map<int32_t, size_t> slot_of;
+
+    std::mutex config_mutex;
+    std::vector<MotorConfig> configs;
+    std::vector<bool> enabled_motors;
+
+    // `next_retry` is only touched by the recovery thread and, while the
+    // motor is not LOST yet, by the worker.
+    struct MotorHealthSlot
+    {
+        std::atomic<uint8_t> state{uint8_t(MotorHealth::LIVE)};
+        std::atomic<uint64_t> losses{0};
+        std::atomic<uint64_t> recoveries{0};
+        std::atomic<uint64_t> failed_attempts{0};
+        double next_retry = 0.0;
+    };
+
+    HealthConfig health_config;
+    std::unique_ptr<MotorHealthSlot[]> health;
+    std::mutex recovery_mutex;
+    std::condition_variable recovery_wakeup;
+    bool recovery_pending = false;
+    bool recovery_running = false;
+    std::thread recovery;
+
+    FeedbackSnapshotBuffer snapshots;
+    JointTransform joints;
+    std::mutex limits_mutex;
+    JointLimiter limiter;
+    std::unique_ptr<MotorFeedbackSlot[]> slots;
+    std::vector<std::unique_ptr<MotorHistory>> history;
+    FilterConfig filter_config;
+    std::vector<MotorStateFilter> filters;
+    std::vector<MotorClockSync> clocks;
+    std::unique_ptr<PcapCapture> capture;
+    std::mutex callback_mutex;
+    std::function<void(const std::vector<MotorFeedback> &)> tick_callback;
+    std::mutex clock_mutex;
+    std::vector<double> clock_periods;
+    std::vector<double> clock_jitters;
+    std::vector<double> arrivals;
+    std::mutex link_mutex;
+    std::vector<LinkMonitor> monitors;
+    std::vector<double> filter_stamps;
+
+    std::mutex staging_mutex;
+    std::vector<StagedCommand> staging[2];
+    size_t active_staging = 0;
+    std::atomic<uint64_t> command_writes{0};
+    std::atomic<uint64_t> command_coalesced{0};
+    std::atomic<uint64_t> command_flushed{0};
+    std::atomic<uint64_t> command_failed{0};
+    std::condition_variable staging_drained;
+    size_t queue_pending = 0;
+    std::atomic<OverflowPolicy> overflow_policy{OverflowPolicy::DROP_OLDEST};
+    std::atomic<double> overflow_timeout{0.01};
+    std::atomic<uint64_t> queue_depth{0};
+    std::atomic<uint64_t> queue_max_depth{0};
+    std::atomic<uint64_t> queue_overflows{0};
+    std::atomic<uint64_t> queue_dropped_newest{0};
+    std::atomic<uint64_t> queue_blocked{0};
+    std::atomic<uint64_t> queue_timeouts{0};
+    std::atomic<uint64_t> queue_sent{0};
+    std::atomic<double> queue_latency_last{0.0};
+    std::atomic<double> queue_latency_sum{0.0};
+    std::atomic<double> queue_latency_max{0.0};
+    std::atomic<bool> synchronous_flush{false};
+    std::atomic<uint8_t> feedback_fields{FEEDBACK_ALL};
+    std::atomic<uint64_t> bridge_calls{0};
+    std::atomic<uint64_t> io_ticks{0};
+    std::atomic<uint64_t> io_last_tick_calls{0};
+    std::atomic<uint64_t> io_max_tick_calls{0};
+    std::atomic<uint64_t> wakeup_ticks{0};
+    std::atomic<double> wakeup_last{0.0};
+    std::atomic<double> wakeup_sum{0.0};
+    std::atomic<double> wakeup_max{0.0};
+    std::atomic<double> age_last{0.0};
+    std::atomic<double> age_max{0.0};
+
+    double tick_period = 0.0;
+    std::mutex schedule_mutex;
+    std::priority_queue<ScheduledCommand, std::vector<ScheduledCommand>, std::greater<ScheduledCommand>> scheduled;
+    uint64_t schedule_sequence = 0;
+    uint64_t schedule_total = 0;
+    uint64_t schedule_dispatched = 0;
+    uint64_t schedule_cancelled = 0;
+    double lateness_last = 0.0;
+    double lateness_sum = 0.0;
+    double lateness_max = 0.0;
+    std::atomic<uint64_t> skew_flushes{0};
+    std::atomic<double> skew_last{0.0};
+    std::atomic<double> skew_sum{0.0};
+    std::atomic<double> skew_max{0.0};
+
+    std::mutex gain_mutex;
+    std::vector<PendingGainTable> pending_gains;
+
+    std::atomic<bool> worker_running{false};
+    std::thread worker;
+    FourierIoExecutor *io_executor = nullptr;
+    uint64_t executor_task = 0;
+    std::vector<MotorFeedback> executor_buffer;
+};
@@ -0,0 +1,255 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <thread>
+
+// Bounded multi-producer multi-consumer queue (Vyukov). try_push and try_pop
+// never block; a full queue makes try_push fail.
+template <typename T>
+class BoundedQueue
+{
+public:
+    explicit BoundedQueue(size_t capacity)
+    {
+        size_t size = 2;
+        while (size < capacity)
+            size <<= 1;
+        mask = size - 1;
+        cells.reset(new Cell[size]);
+        for (size_t i = 0; i < size; ++i)
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    bool try_push(const T &value)
+    {
+        size_t position = tail.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            Cell &cell = cells[position & mask];
+            size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            intptr_t diff = intptr_t(sequence) - intptr_t(position);
+            if (diff == 0)
+            {
+                if (tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                {
+                    cell.value = value;
+                    cell.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0)
+                return false;
+            else
+                position = tail.load(std::memory_order_relaxed);
+        }
+    }
+
+    bool try_pop(T &value)
+    {
+        size_t position = head.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            Cell &cell = cells[position & mask];
+            size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            intptr_t diff = intptr_t(sequence) - intptr_t(position + 1);
+            if (diff == 0)
+            {
+                if (head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                {
+                    value = cell.value;
+                    cell.sequence.store(position + mask + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0)
+                return false;
+            else
+                position = head.load(std::memory_order_relaxed);
+        }
+    }
+
+    // Approximate number of queued items.
+    size_t size() const
+    {
+        size_t t = tail.load(std::memory_order_relaxed);
+        size_t h = head.load(std::memory_order_relaxed);
+        return t > h ? t - h : 0;
+    }
+
+private:
+    struct Cell
+    {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    std::unique_ptr<Cell[]> cells;
+    size_t mask = 0;
+    alignas(64) std::atomic<size_t> tail{0};
+    alignas(64) std::atomic<size_t> head{0};
+};
+
+enum class CaptureDirection : uint8_t
+{
+    TX,
+    RX,
+    API,
+};
+
+struct CaptureRecord
+{
+    int64_t time_ns = 0;
+    const char *call = "";
+    int32_t id = 0;
+    float values[4] = {};
+    uint8_t value_count = 0;
+    CaptureDirection direction = CaptureDirection::API;
+    bool ok = true;
+};
+
+// Writes every bridge exchange of a manager to a pcap file (LINKTYPE_USER0,
+// nanosecond timestamps). Producers only enqueue a fixed-size record; a
+// background thread formats and writes it. When the queue is full the record
+// is dropped and counted, so producers never wait on the disk.
+//
+// Each packet is one text line, e.g. "TX set_position id=13 0.5 ok", readable
+// in Wireshark's byte view or with `tshark -x`.
+class PcapCapture
+{
+public:
+    PcapCapture(const std::string &path, size_t capacity = 1 << 16)
+        : queue(capacity)
+    {
+        file = std::fopen(path.c_str(), "wb");
+        if (!file)
+            return;
+        const uint32_t magic_ns = 0xa1b23c4d;
+        const uint16_t version_major = 2, version_minor = 4;
+        const int32_t zone = 0;
+        const uint32_t sigfigs = 0, snaplen = 65535, linktype_user0 = 147;
+        std::fwrite(&magic_ns, sizeof(magic_ns), 1, file);
+        std::fwrite(&version_major, sizeof(version_major), 1, file);
+        std::fwrite(&version_minor, sizeof(version_minor), 1, file);
+        std::fwrite(&zone, sizeof(zone), 1, file);
+        std::fwrite(&sigfigs, sizeof(sigfigs), 1, file);
+        std::fwrite(&snaplen, sizeof(snaplen), 1, file);
+        std::fwrite(&linktype_user0, sizeof(linktype_user0), 1, file);
+
+        auto wall = std::chrono::system_clock::now().time_since_epoch();
+        auto mono = std::chrono::steady_clock::now().time_since_epoch();
+        wall_offset_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(wall - mono).count();
+        writer = std::thread([this]
+                             { drain(); });
+    }
+
+    ~PcapCapture()
+    {
+        writer_running.store(false, std::memory_order_release);
+        if (writer.joinable())
+            writer.join();
+        if (file)
+            std::fclose(file);
+    }
+
+    PcapCapture(const PcapCapture &) = delete;
+    PcapCapture &operator=(const PcapCapture &) = delete;
+
+    bool is_open() const
+    {
+        return file != nullptr;
+    }
+
+    void record(CaptureDirection direction, const char *call, int32_t id, bool ok,
+                std::initializer_list<float> values = {})
+    {
+        CaptureRecord entry;
+        entry.time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            std::chrono::steady_clock::now().time_since_epoch())
+                            .count();
+        entry.direction = direction;
+        entry.call = call;
+        entry.id = id;
+        entry.ok = ok;
+        for (float value : values)
+        {
+            if (entry.value_count == 4)
+                break;
+            entry.values[entry.value_count++] = value;
+        }
+        if (queue.try_push(entry))
+            captured.fetch_add(1, std::memory_order_relaxed);
+        else
+            dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    uint64_t captured_count() const
+    {
+        return captured.load(std::memory_order_relaxed);
+    }
+
+    uint64_t dropped_count() const
+    {
+        return dropped.load(std::memory_order_relaxed);
+    }
+
+private:
+    void drain()
+    {
+        CaptureRecord entry;
+        for (;;)
+        {
+            bool stopping = !writer_running.load(std::memory_order_acquire);
+            bool wrote = false;
+            while (queue.try_pop(entry))
+            {
+                write(entry);
+                wrote = true;
+            }
+            if (stopping)
+                break;
+            if (wrote)
+                std::fflush(file);
+            else
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        std::fflush(file);
+    }
+
+    void write(const CaptureRecord &entry)
+    {
+        static const char *directions[] = {"TX", "RX", "API"};
+        char payload[160];
+        int length = std::snprintf(payload, sizeof(payload), "%s %s id=%d",
+                                   directions[int(entry.direction)], entry.call, entry.id);
+        for (uint8_t i = 0; i < entry.value_count && length < int(sizeof(payload)); ++i)
+            length += std::snprintf(payload + length, sizeof(payload) - length, " %g", entry.values[i]);
+        if (length < int(sizeof(payload)))
+            length += std::snprintf(payload + length, sizeof(payload) - length, entry.ok ? " ok" : " failed");
+        if (length >= int(sizeof(payload)))
+            length = int(sizeof(payload)) - 1;
+
+        int64_t wall_ns = entry.time_ns + wall_offset_ns;
+        uint32_t header[4] = {
+            uint32_t(wall_ns / 1000000000),
+            uint32_t(wall_ns % 1000000000),
+            uint32_t(length),
+            uint32_t(length),
+        };
+        std::fwrite(header, sizeof(header), 1, file);
+        std::fwrite(payload, 1, size_t(length), file);
+    }
+
+    BoundedQueue<CaptureRecord> queue;
+    std::FILE *file = nullptr;
+    int64_t wall_offset_ns = 0;
+    std::atomic<uint64_t> captured{0};
+    std::atomic<uint64_t> dropped{0};
+    std::atomic<bool> writer_running{true};
+    std::thread writer;
+};
@@ -0,0 +1,170 @@
+#pragma once
+
+#include <future>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "fourier_motor_manager.h"
+
+// Splits a robot's motors by network interface. Each interface gets its own
+// FourierMotorManager, and so its own bridge connection and I/O worker, so the
+// cycle time of one bus does not depend on how many motors sit on the others.
+class ShardedMotorManager
+{
+public:
+    // `interfaces` maps every motor id to the name of the interface it is wired to.
+    ShardedMotorManager(const std::map<int32_t, std::string> &interfaces)
+    {
+        std::map<std::string, std::vector<int32_t>> groups;
+        std::map<int32_t, size_t> rank;
+        for (const auto &entry : interfaces)
+        {
+            groups[entry.second].push_back(entry.first);
+            rank.emplace(entry.first, motor_count++);
+        }
+
+        for (const auto &group : groups)
+        {
+            Shard shard;
+            shard.interface = group.first;
+            shard.manager = std::make_unique<FourierMotorManager>(group.second);
+            for (int32_t id : group.second)
+            {
+                shard_of[id] = shards.size();
+                shard.slots.push_back(rank[id]);
+            }
+            shards.push_back(std::move(shard));
+        }
+    }
+
+    ~ShardedMotorManager()
+    {
+        stop();
+    }
+
+    std::vector<std::string> interfaces() const
+    {
+        std::vector<std::string> names;
+        for (const auto &shard : shards)
+            names.push_back(shard.interface);
+        return names;
+    }
+
+    FourierMotorManager &manager_for(int32_t id)
+    {
+        return *shards[shard_of.at(id)].manager;
+    }
+
+    FourierMotorManager &shard(const std::string &interface)
+    {
+        for (auto &shard : shards)
+        {
+            if (shard.interface == interface)
+                return *shard.manager;
+        }
+        throw std::out_of_range("unknown interface " + interface);
+    }
+
+    // Waits on every interface concurrently, so the total wait is bounded by
+    // `timeout` rather than by `timeout` times the number of interfaces.
+    bool wait_for_first_messages(float timeout)
+    {
+        std::vector<std::future<bool>> pending;
+        for (auto &shard : shards)
+        {
+            FourierMotorManager *manager = shard.manager.get();
+            pending.push_back(std::async(std::launch::async, [manager, timeout]
+                                         { return manager->wait_for_first_messages(timeout); }));
+        }
+        bool ok = true;
+        for (auto &result : pending)
+            ok = result.get() && ok;
+        return ok;
+    }
+
+    MotorTopology topology()
+    {
+        MotorTopology result;
+        for (auto &shard : shards)
+        {
+            MotorTopology part = shard.manager->topology(shard.interface);
+            result.motors.insert(result.motors.end(), part.motors.begin(), part.motors.end());
+        }
+        return result;
+    }
+
+    // Warm-starts every interface concurrently from a cached topology.
+    bool warm_start(const MotorTopology &cache, float timeout)
+    {
+        std::vector<std::future<bool>> pending;
+        for (auto &shard : shards)
+        {
+            FourierMotorManager *manager = shard.manager.get();
+            pending.push_back(std::async(std::launch::async, [manager, &cache, timeout]
+                                         { return manager->warm_start(cache, timeout); }));
+        }
+        bool ok = true;
+        for (auto &result : pending)
+            ok = result.get() && ok;
+        return ok;
+    }
+
+    bool start(float rate_hz)
+    {
+        bool ok = true;
+        for (auto &shard : shards)
+            ok = shard.manager->start(rate_hz) && ok;
+        return ok;
+    }
+
+    // Applies one outgoing queue overflow policy to every interface; each
+    // interface keeps its own queue_stats().
+    void set_overflow_policy(OverflowPolicy policy, double block_timeout = 0.01)
+    {
+        for (auto &shard : shards)
+            shard.manager->set_overflow_policy(policy, block_timeout);
+    }
+
+    // Runs every interface's ticks on `executor` instead of one thread each.
+    bool start(FourierIoExecutor &executor, float rate_hz)
+    {
+        bool ok = true;
+        for (auto &shard : shards)
+            ok = shard.manager->start(executor, rate_hz) && ok;
+        return ok;
+    }
+
+    void stop()
+    {
+        for (auto &shard : shards)
+            shard.manager->stop();
+    }
+
+    // Merged feedback of all interfaces, ordered by motor id.
+    void snapshot(std::vector<MotorFeedback> &out)
+    {
+        out.resize(motor_count);
+        for (auto &shard : shards)
+        {
+            shard.manager->snapshot(shard.buffer);
+            for (size_t i = 0; i < shard.slots.size(); ++i)
+                out[shard.slots[i]] = shard.buffer[i];
+        }
+    }
+
+private:
+    struct Shard
+    {
+        std::string interface;
+        std::unique_ptr<FourierMotorManager> manager;
+        std::vector<size_t> slots;
+        std::vector<MotorFeedback> buffer;
+    };
+
+    std::vector<Shard> shards;
+    std::map<int32_t, size_t> shard_of;
+    size_t motor_count = 0;
+};
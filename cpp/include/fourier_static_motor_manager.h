@@ -0,0 +1,285 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "rust/cxx.h"
+#include "fourier_comm/src/cpp.rs.h"
+#include "fourier_joint_calibration.h"
+#include "fourier_joint_limits.h"
+
+struct MotorManagerSync;
+
+class MotorState
+{
+public:
+    float position() const { return position_; }
+    float velocity() const { return velocity_; }
+    float current() const { return current_; }
+    float effort() const { return effort_; }
+    bool valid() const { return valid_; }
+
+private:
+    template <int32_t... Ids>
+    friend class StaticMotorManager;
+
+    float position_ = 0.0f;
+    float velocity_ = 0.0f;
+    float current_ = 0.0f;
+    float effort_ = 0.0f;
+    bool valid_ = false;
+};
+
+class MotorCommand
+{
+public:
+    void set_position(float value)
+    {
+        position_ = value;
+        pending_ |= POSITION;
+    }
+
+    void set_velocity(float value)
+    {
+        velocity_ = value;
+        pending_ |= VELOCITY;
+    }
+
+    void set_current(float value)
+    {
+        current_ = value;
+        pending_ |= CURRENT;
+    }
+
+    void set_effort(float value)
+    {
+        effort_ = value;
+        pending_ |= EFFORT;
+    }
+
+    bool pending() const { return pending_ != 0; }
+    void clear() { pending_ = 0; }
+
+private:
+    template <int32_t... Ids>
+    friend class StaticMotorManager;
+
+    enum : uint8_t
+    {
+        POSITION = 1 << 0,
+        VELOCITY = 1 << 1,
+        CURRENT = 1 << 2,
+        EFFORT = 1 << 3,
+    };
+
+    float position_ = 0.0f;
+    float velocity_ = 0.0f;
+    float current_ = 0.0f;
+    float effort_ = 0.0f;
+    uint8_t pending_ = 0;
+};
+
+// Manager for a motor set fixed at compile time. Ids are resolved to slots
+// while compiling, so get<Id>() / command<Id>() are plain array accesses and
+// the batched update() / send() loops are unrolled over the id pack.
+// Commands are in motor space; send() clamps them to the joint limits of
+// set_calibration() and refuses non-finite values, like FourierMotorManager.
+template <int32_t... Ids>
+class StaticMotorManager
+{
+public:
+    static constexpr std::size_t size = sizeof...(Ids);
+    static constexpr std::array<int32_t, sizeof...(Ids)> ids = {Ids...};
+
+    static_assert(size > 0, "StaticMotorManager needs at least one motor id");
+
+    static constexpr std::size_t find(int32_t id)
+    {
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            if (ids[i] == id)
+                return i;
+        }
+        return size;
+    }
+
+    static constexpr bool unique_ids()
+    {
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            for (std::size_t j = i + 1; j < size; ++j)
+            {
+                if (ids[i] == ids[j])
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    static_assert(unique_ids(), "StaticMotorManager motor ids must be unique");
+
+    template <int32_t Id>
+    static constexpr std::size_t index_of()
+    {
+        constexpr std::size_t index = find(Id);
+        static_assert(index < size, "motor id is not part of this StaticMotorManager");
+        return index;
+    }
+
+    // make_motor_manager_v1 only takes a std::vector, so construction is the
+    // one place that touches the heap.
+    StaticMotorManager()
+        : manager(make_motor_manager_v1(std::vector<int32_t>{Ids...})),
+          limiter(JointCalibration(), JointTransform(JointCalibration(), {Ids...}), {Ids...}) {}
+
+    // Takes the joint limits of `calibration` (moved into motor space through
+    // its offsets, signs and gear ratios) for every later send().
+    void set_calibration(const JointCalibration &calibration)
+    {
+        std::vector<int32_t> motor_ids{Ids...};
+        limiter = JointLimiter(calibration, JointTransform(calibration, motor_ids), motor_ids);
+    }
+
+    // How often the limits of motor `Id` clamped a command, and how many
+    // non-finite commands for it were refused.
+    template <int32_t Id>
+    JointLimitStats limit_stats() const
+    {
+        return limiter.stats(index_of<Id>());
+    }
+
+    bool wait_for_first_messages(float timeout)
+    {
+        return manager->cxx_wait_for_first_messages(timeout);
+    }
+
+    bool enable_all()
+    {
+        bool ok = true;
+        ((ok = manager->cxx_enable(Ids) && ok), ...);
+        return ok;
+    }
+
+    bool disable_all()
+    {
+        bool ok = true;
+        ((ok = manager->cxx_disable(Ids) && ok), ...);
+        return ok;
+    }
+
+    bool set_control_mode_all(const std::string &mode)
+    {
+        bool ok = true;
+        ((ok = manager->cxx_set_control_mode(Ids, mode) && ok), ...);
+        return ok;
+    }
+
+    template <int32_t Id>
+    const MotorState &get() const
+    {
+        return state[index_of<Id>()];
+    }
+
+    template <int32_t Id>
+    MotorCommand &command()
+    {
+        return commands[index_of<Id>()];
+    }
+
+    const std::array<MotorState, size> &states() const { return state; }
+
+    // Refreshes every slot from the bridge. Returns false if any motor could
+    // not be read; that motor's slot is marked invalid and keeps its last values.
+    bool update()
+    {
+        return update_all(std::make_index_sequence<size>{});
+    }
+
+    // Sends every pending command and clears it. Returns false if the bridge
+    // rejected any of them or a non-finite one was refused (and not sent).
+    bool send()
+    {
+        return send_all(std::make_index_sequence<size>{});
+    }
+
+private:
+    template <std::size_t... I>
+    bool update_all(std::index_sequence<I...>)
+    {
+        bool ok = true;
+        ((ok = update_one(ids[I], state[I]) && ok), ...);
+        return ok;
+    }
+
+    template <std::size_t... I>
+    bool send_all(std::index_sequence<I...>)
+    {
+        bool ok = true;
+        ((ok = send_one(I, commands[I]) && ok), ...);
+        return ok;
+    }
+
+    bool update_one(int32_t id, MotorState &slot)
+    {
+        try
+        {
+            // Read everything first so a failure leaves the old values whole.
+            float position = manager->cxx_get_position(id);
+            float velocity = manager->cxx_get_velocity(id);
+            float current = manager->cxx_get_current(id);
+            float effort = manager->cxx_get_effort(id);
+            slot.position_ = position;
+            slot.velocity_ = velocity;
+            slot.current_ = current;
+            slot.effort_ = effort;
+            slot.valid_ = true;
+        }
+        catch (const rust::Error &)
+        {
+            slot.valid_ = false;
+        }
+        return slot.valid_;
+    }
+
+    bool send_one(std::size_t index, MotorCommand &cmd)
+    {
+        int32_t id = ids[index];
+        bool ok = true;
+        float value = 0.0f;
+        if (cmd.pending_ & MotorCommand::POSITION)
+        {
+            value = cmd.position_;
+            ok = limiter.clamp(LimitKind::POSITION, index, value) && manager->cxx_set_position(id, value) && ok;
+        }
+        if (cmd.pending_ & MotorCommand::VELOCITY)
+        {
+            value = cmd.velocity_;
+            ok = limiter.clamp(LimitKind::VELOCITY, index, value) && manager->cxx_set_velocity(id, value) && ok;
+        }
+        if (cmd.pending_ & MotorCommand::CURRENT)
+        {
+            // Current has no limit, but a non-finite one is still refused.
+            value = cmd.current_;
+            if (!std::isfinite(value))
+                limiter.reject(index);
+            ok = std::isfinite(value) && manager->cxx_set_current(id, value) && ok;
+        }
+        if (cmd.pending_ & MotorCommand::EFFORT)
+        {
+            value = cmd.effort_;
+            ok = limiter.clamp(LimitKind::EFFORT, index, value) && manager->cxx_set_effort(id, value) && ok;
+        }
+        cmd.clear();
+        return ok;
+    }
+
+    rust::Box<MotorManagerSync> manager;
+    JointLimiter limiter;
+    std::array<MotorState, size> state{};
+    std::array<MotorCommand, size> commands{};
+};
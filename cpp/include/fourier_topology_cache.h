@@ -0,0 +1,136 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Last known configuration of one motor. Gains are only present once they have
+// been set through the manager, since the bridge cannot read them back.
+struct MotorConfig
+{
+    int32_t id = 0;
+    std::string interface;
+    std::string control_mode;
+    bool has_pid_gain = false;
+    float position_kp = 0.0f;
+    float velocity_kp = 0.0f;
+    float velocity_ki = 0.0f;
+    bool has_pd_gain = false;
+    float kp = 0.0f;
+    float kd = 0.0f;
+};
+
+// Robot topology persisted between process starts: one line per motor,
+//   motor <id> <interface> <mode> pid <position_kp> <velocity_kp> <velocity_ki> pd <kp> <kd>
+// where "-" marks a field that was never set.
+struct MotorTopology
+{
+    std::vector<MotorConfig> motors;
+
+    std::vector<int32_t> ids() const
+    {
+        std::vector<int32_t> result;
+        for (const auto &motor : motors)
+            result.push_back(motor.id);
+        return result;
+    }
+
+    // Input for ShardedMotorManager.
+    std::map<int32_t, std::string> interfaces() const
+    {
+        std::map<int32_t, std::string> result;
+        for (const auto &motor : motors)
+            result[motor.id] = motor.interface;
+        return result;
+    }
+
+    bool save(const std::string &path) const
+    {
+        std::string temporary = path + ".tmp";
+        {
+            std::ofstream out(temporary, std::ios::trunc);
+            if (!out)
+                return false;
+            out.precision(9);
+            for (const auto &motor : motors)
+            {
+                out << "motor " << motor.id << ' '
+                    << field(motor.interface) << ' '
+                    << field(motor.control_mode) << " pid ";
+                if (motor.has_pid_gain)
+                    out << motor.position_kp << ' ' << motor.velocity_kp << ' ' << motor.velocity_ki;
+                else
+                    out << "- - -";
+                out << " pd ";
+                if (motor.has_pd_gain)
+                    out << motor.kp << ' ' << motor.kd;
+                else
+                    out << "- -";
+                out << '\n';
+            }
+            if (!out)
+                return false;
+        }
+        // Replace atomically so a crash never leaves a half-written cache.
+        return std::rename(temporary.c_str(), path.c_str()) == 0;
+    }
+
+    bool load(const std::string &path)
+    {
+        std::ifstream in(path);
+        if (!in)
+            return false;
+        std::vector<MotorConfig> loaded;
+        std::string line;
+        while (std::getline(in, line))
+        {
+            if (line.empty())
+                continue;
+            std::istringstream fields(line);
+            std::string tag, pid_tag, pd_tag;
+            std::string pid[3], pd[2];
+            MotorConfig motor;
+            if (!(fields >> tag >> motor.id >> motor.interface >> motor.control_mode >> pid_tag >> pid[0] >> pid[1] >> pid[2] >> pd_tag >> pd[0] >> pd[1]) ||
+                tag != "motor" || pid_tag != "pid" || pd_tag != "pd")
+                return false;
+            if (motor.interface == "-")
+                motor.interface.clear();
+            if (motor.control_mode == "-")
+                motor.control_mode.clear();
+            try
+            {
+                motor.has_pid_gain = pid[0] != "-";
+                if (motor.has_pid_gain)
+                {
+                    motor.position_kp = std::stof(pid[0]);
+                    motor.velocity_kp = std::stof(pid[1]);
+                    motor.velocity_ki = std::stof(pid[2]);
+                }
+                motor.has_pd_gain = pd[0] != "-";
+                if (motor.has_pd_gain)
+                {
+                    motor.kp = std::stof(pd[0]);
+                    motor.kd = std::stof(pd[1]);
+                }
+            }
+            catch (const std::logic_error &)
+            {
+                return false;
+            }
+            loaded.push_back(motor);
+        }
+        motors.swap(loaded);
+        return true;
+    }
+
+private:
+    static std::string field(const std::string &value)
+    {
+        return value.empty() ? std::string("-") : value;
+    }
+};
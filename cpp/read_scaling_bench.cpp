@@ -0,0 +1,131 @@
+#include "fourier_motor_feedback.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Multi-reader throughput of per-motor feedback storage. One writer publishes
+// every motor at `rate_hz`, like the I/O worker; each reader thread owns a
+// contiguous group of motors (a limb) and reads them in a loop. Compares the
+// cache-line aligned seqlock slots against one mutex-guarded packed array.
+// Needs no motors and no bridge library.
+//
+//   ./read_scaling_bench [motors] [rate_hz] [seconds]
+
+namespace
+{
+    struct PackedStore
+    {
+        std::mutex mutex;
+        std::vector<MotorFeedback> motors;
+
+        void store(size_t i, const MotorFeedback &value)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            motors[i] = value;
+        }
+
+        void load(size_t i, MotorFeedback &value)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            value = motors[i];
+        }
+    };
+
+    struct SlotStore
+    {
+        std::unique_ptr<MotorFeedbackSlot[]> slots;
+
+        void store(size_t i, const MotorFeedback &value) { slots[i].store(value); }
+        void load(size_t i, MotorFeedback &value) { slots[i].load(value); }
+    };
+
+    template <typename Store>
+    double measure(Store &store, size_t motors, size_t readers, double rate_hz, double seconds)
+    {
+        std::atomic<bool> done{false};
+        std::vector<uint64_t> counts(readers * 8, 0);
+
+        std::thread writer([&]
+                           {
+            auto period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<double>(1.0 / rate_hz));
+            auto next = std::chrono::steady_clock::now();
+            MotorFeedback value;
+            value.valid = true;
+            while (!done.load(std::memory_order_relaxed))
+            {
+                for (size_t i = 0; i < motors; ++i)
+                {
+                    value.id = int32_t(i);
+                    value.position += 1e-3f;
+                    store.store(i, value);
+                }
+                next += period;
+                std::this_thread::sleep_until(next);
+            } });
+
+        std::vector<std::thread> threads;
+        for (size_t r = 0; r < readers; ++r)
+        {
+            threads.emplace_back([&, r]
+                                 {
+                size_t begin = motors * r / readers;
+                size_t end = motors * (r + 1) / readers;
+                MotorFeedback value;
+                uint64_t count = 0;
+                float sink = 0.0f;
+                while (!done.load(std::memory_order_relaxed))
+                {
+                    for (size_t i = begin; i < end; ++i)
+                    {
+                        store.load(i, value);
+                        sink += value.position;
+                    }
+                    count += end - begin;
+                }
+                // Padded so the counters do not share a cache line either.
+                counts[r * 8] = count + (sink < 0.0f ? 1 : 0); });
+        }
+
+        std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+        done.store(true);
+        writer.join();
+        for (auto &thread : threads)
+            thread.join();
+
+        uint64_t total = 0;
+        for (size_t r = 0; r < readers; ++r)
+            total += counts[r * 8];
+        return double(total) / seconds;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    size_t motors = argc > 1 ? size_t(std::atoi(argv[1])) : 32;
+    double rate_hz = argc > 2 ? std::atof(argv[2]) : 1000.0;
+    double seconds = argc > 3 ? std::atof(argv[3]) : 1.0;
+
+    size_t max_readers = std::thread::hardware_concurrency();
+    if (max_readers < 2)
+        max_readers = 2;
+
+    PackedStore packed;
+    packed.motors.resize(motors);
+    SlotStore aligned;
+    aligned.slots.reset(new MotorFeedbackSlot[motors]);
+
+    std::printf("%8s %16s %16s\n", "readers", "mutex Mreads/s", "slots Mreads/s");
+    for (size_t readers = 1; readers <= max_readers && readers <= motors; readers *= 2)
+    {
+        double locked = measure(packed, motors, readers, rate_hz, seconds);
+        double lockfree = measure(aligned, motors, readers, rate_hz, seconds);
+        std::printf("%8zu %16.2f %16.2f\n", readers, locked * 1e-6, lockfree * 1e-6);
+        std::fflush(stdout);
+    }
+}
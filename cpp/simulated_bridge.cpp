@@ -0,0 +1,306 @@
+#include "rust/cxx.h"
+#include "fourier_comm/src/cpp.rs.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// In-process stand-in for libfourier_comm: implements the MotorManagerSync
+// bridge and the few rust::String / rust::Error members the headers use, so
+// benches can be linked and run without motors. Every motor sends a frame
+// every `frame_period` seconds (phases staggered per id) and moves its
+// position a fixed fraction towards the last commanded one on each frame.
+// Getters never fail.
+
+namespace
+{
+    const double frame_period = 1e-3;
+    const float response = 0.2f;
+
+    double now_seconds()
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    struct SimMotor
+    {
+        double phase = 0.0;
+        int64_t frame = 0;
+        float position = 0.0f;
+        float velocity = 0.0f;
+        float current = 0.0f;
+        float effort = 0.0f;
+        float target = 0.0f;
+        bool enabled = false;
+        std::string mode = "position";
+    };
+
+    struct SimMotors
+    {
+        std::mutex mutex;
+        std::unordered_map<int32_t, SimMotor> motors;
+
+        // Advances the motor to its latest frame and returns it, or nullptr
+        // for an id this set does not have.
+        SimMotor *at(int32_t id, double &age)
+        {
+            auto it = motors.find(id);
+            if (it == motors.end())
+                return nullptr;
+            SimMotor &motor = it->second;
+            double elapsed = now_seconds() - motor.phase;
+            int64_t frame = int64_t(std::floor(elapsed / frame_period));
+            for (int64_t steps = std::min<int64_t>(frame - motor.frame, 100); steps > 0; --steps)
+            {
+                float step = response * (motor.target - motor.position);
+                motor.position += step;
+                motor.velocity = float(step / frame_period);
+            }
+            motor.frame = frame;
+            age = elapsed - double(frame) * frame_period;
+            return &motor;
+        }
+    };
+
+    // The bridge methods are const; the simulated state behind them is not.
+    SimMotors &sim(const MotorManagerSync *self)
+    {
+        return *const_cast<SimMotors *>(reinterpret_cast<const SimMotors *>(self));
+    }
+
+    // Callers hold the set's mutex.
+    SimMotor *motor_of(const MotorManagerSync *self, int32_t id)
+    {
+        double age = 0.0;
+        return sim(self).at(id, age);
+    }
+
+    bool set_value(const MotorManagerSync *self, int32_t id, float SimMotor::*field, float value)
+    {
+        SimMotors &motors = sim(self);
+        std::lock_guard<std::mutex> lock(motors.mutex);
+        SimMotor *motor = motor_of(self, id);
+        if (!motor)
+            return false;
+        motor->*field = value;
+        return true;
+    }
+
+    float get_value(const MotorManagerSync *self, int32_t id, float SimMotor::*field)
+    {
+        SimMotors &motors = sim(self);
+        std::lock_guard<std::mutex> lock(motors.mutex);
+        SimMotor *motor = motor_of(self, id);
+        return motor ? motor->*field : 0.0f;
+    }
+
+    rust::String text_of(const MotorManagerSync *self, int32_t id, bool state)
+    {
+        SimMotors &motors = sim(self);
+        std::lock_guard<std::mutex> lock(motors.mutex);
+        double age = 0.0;
+        SimMotor *motor = motors.at(id, age);
+        if (!motor)
+            return rust::String("unknown");
+        if (!state)
+            return rust::String(motor->mode);
+        char text[32];
+        std::snprintf(text, sizeof(text), "%.3f\xC2\xB5s", age * 1e6);
+        return rust::String(text);
+    }
+}
+
+rust::Box<MotorManagerSync> make_motor_manager_v1(std::vector<int32_t> const &ids) noexcept
+{
+    SimMotors *motors = new SimMotors;
+    double start = now_seconds();
+    for (size_t i = 0; i < ids.size(); ++i)
+    {
+        SimMotor &motor = motors->motors[ids[i]];
+        motor.phase = start + frame_period * double(i % 16) / 16.0;
+    }
+    return rust::Box<MotorManagerSync>::from_raw(reinterpret_cast<MotorManagerSync *>(motors));
+}
+
+bool MotorManagerSync::cxx_wait_for_first_messages(float) const noexcept
+{
+    return true;
+}
+
+bool MotorManagerSync::cxx_enable(int32_t id) const noexcept
+{
+    SimMotors &motors = sim(this);
+    std::lock_guard<std::mutex> lock(motors.mutex);
+    SimMotor *motor = motor_of(this, id);
+    if (motor)
+        motor->enabled = true;
+    return motor != nullptr;
+}
+
+bool MotorManagerSync::cxx_disable(int32_t id) const noexcept
+{
+    SimMotors &motors = sim(this);
+    std::lock_guard<std::mutex> lock(motors.mutex);
+    SimMotor *motor = motor_of(this, id);
+    if (motor)
+        motor->enabled = false;
+    return motor != nullptr;
+}
+
+float MotorManagerSync::cxx_get_position(int32_t id) const
+{
+    return get_value(this, id, &SimMotor::position);
+}
+
+bool MotorManagerSync::cxx_set_position(int32_t id, float value) const noexcept
+{
+    return set_value(this, id, &SimMotor::target, value);
+}
+
+float MotorManagerSync::cxx_get_velocity(int32_t id) const
+{
+    return get_value(this, id, &SimMotor::velocity);
+}
+
+bool MotorManagerSync::cxx_set_velocity(int32_t id, float value) const noexcept
+{
+    return set_value(this, id, &SimMotor::velocity, value);
+}
+
+float MotorManagerSync::cxx_get_current(int32_t id) const
+{
+    return get_value(this, id, &SimMotor::current);
+}
+
+bool MotorManagerSync::cxx_set_current(int32_t id, float value) const noexcept
+{
+    return set_value(this, id, &SimMotor::current, value);
+}
+
+float MotorManagerSync::cxx_get_effort(int32_t id) const
+{
+    return get_value(this, id, &SimMotor::effort);
+}
+
+bool MotorManagerSync::cxx_set_effort(int32_t id, float value) const noexcept
+{
+    return set_value(this, id, &SimMotor::effort, value);
+}
+
+bool MotorManagerSync::cxx_set_control_mode(int32_t id, std::string const &value) const noexcept
+{
+    SimMotors &motors = sim(this);
+    std::lock_guard<std::mutex> lock(motors.mutex);
+    SimMotor *motor = motor_of(this, id);
+    if (motor)
+        motor->mode = value;
+    return motor != nullptr;
+}
+
+rust::String MotorManagerSync::cxx_get_control_mode(int32_t id) const noexcept
+{
+    return text_of(this, id, false);
+}
+
+rust::String MotorManagerSync::cxx_get_motor_state(int32_t id) const noexcept
+{
+    return text_of(this, id, true);
+}
+
+bool MotorManagerSync::cxx_set_motor_pid_gain(int32_t id, float, float, float) const noexcept
+{
+    SimMotors &motors = sim(this);
+    std::lock_guard<std::mutex> lock(motors.mutex);
+    return motor_of(this, id) != nullptr;
+}
+
+bool MotorManagerSync::cxx_set_control_pd_gain(int32_t id, float, float) const noexcept
+{
+    SimMotors &motors = sim(this);
+    std::lock_guard<std::mutex> lock(motors.mutex);
+    return motor_of(this, id) != nullptr;
+}
+
+bool MotorManagerSync::cxx_stop() const noexcept
+{
+    return true;
+}
+
+namespace rust
+{
+    inline namespace cxxbridge1
+    {
+        template <>
+        void Box<::MotorManagerSync>::drop() noexcept
+        {
+            delete reinterpret_cast<SimMotors *>(ptr);
+        }
+
+        // The string keeps a heap std::string in its first word.
+        static std::string *&text(std::array<std::uintptr_t, 3> &repr)
+        {
+            return reinterpret_cast<std::string *&>(repr[0]);
+        }
+
+        static const std::string &text(const std::array<std::uintptr_t, 3> &repr)
+        {
+            static const std::string empty;
+            const std::string *value = reinterpret_cast<const std::string *>(repr[0]);
+            return value ? *value : empty;
+        }
+
+        String::String() noexcept : repr{} {}
+
+        String::String(const String &other) noexcept : repr{}
+        {
+            text(repr) = new std::string(text(other.repr));
+        }
+
+        String::String(String &&other) noexcept : repr(other.repr)
+        {
+            other.repr = {};
+        }
+
+        String::~String() noexcept
+        {
+            delete text(repr);
+        }
+
+        String::String(const std::string &value) : repr{}
+        {
+            text(repr) = new std::string(value);
+        }
+
+        String::String(const char *value) : repr{}
+        {
+            text(repr) = new std::string(value);
+        }
+
+        String::operator std::string() const
+        {
+            return text(repr);
+        }
+
+        const char *String::data() const noexcept
+        {
+            return text(repr).data();
+        }
+
+        std::size_t String::size() const noexcept
+        {
+            return text(repr).size();
+        }
+
+        Error::~Error() noexcept {}
+
+        const char *Error::what() const noexcept
+        {
+            return msg;
+        }
+    }
+}
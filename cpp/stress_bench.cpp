@@ -0,0 +1,284 @@
+#include "fourier_motor_manager.h"
+#include <sys/resource.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+// Drives 10..200 motor ids at 500 Hz, 1 kHz and 2 kHz and reports how the
+// manager keeps up. Motors are never enabled, and every command holds the
+// position just read back.
+//
+// The `direct` mode calls the bridge from the bench thread (read_feedback and
+// synchronous setters). The `worker` mode runs the manager's I/O worker at the
+// step rate, has the bench thread stage commands from the published snapshot
+// like a controller would, and reports io_stats(), queue_stats() and
+// latency_stats().
+//
+// Linked against libfourier_comm (`stress_bench`) it needs 10..200 real or
+// externally simulated motors starting at `first_id`; `stress_bench_sim` links
+// the in-process simulated bridge instead and needs no motors.
+//
+//   ./stress_bench [first_id] [seconds_per_step] [direct|worker|both]
+
+namespace
+{
+    struct StepResult
+    {
+        size_t motors = 0;
+        float rate_hz = 0.0f;
+        double achieved_hz = 0.0;
+        double feedback_hz = 0.0;
+        double p50_us = 0.0;
+        double p99_us = 0.0;
+        double max_us = 0.0;
+        uint64_t overruns = 0;
+        uint64_t drops = 0;
+        double cpu_percent = 0.0;
+        // Worker mode only.
+        double calls_per_tick = 0.0;
+        uint64_t max_tick_calls = 0;
+        uint64_t coalesced = 0;
+        double queue_mean_us = 0.0;
+        double queue_max_us = 0.0;
+        double wakeup_mean_us = 0.0;
+        double wakeup_max_us = 0.0;
+        double age_max_us = 0.0;
+    };
+
+    double cpu_seconds()
+    {
+        rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+        return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec +
+               1e-6 * (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec);
+    }
+
+    double percentile(std::vector<double> &samples, double fraction)
+    {
+        if (samples.empty())
+            return 0.0;
+        size_t index = size_t(fraction * double(samples.size() - 1));
+        std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+        return samples[index];
+    }
+
+    std::vector<int32_t> motor_ids(int32_t first_id, size_t motors)
+    {
+        std::vector<int32_t> ids;
+        for (size_t i = 0; i < motors; ++i)
+            ids.push_back(first_id + int32_t(i));
+        return ids;
+    }
+
+    void finish_latencies(StepResult &result, std::vector<double> &latencies)
+    {
+        result.p50_us = 1e6 * percentile(latencies, 0.50);
+        result.p99_us = 1e6 * percentile(latencies, 0.99);
+        result.max_us = latencies.empty() ? 0.0 : 1e6 * *std::max_element(latencies.begin(), latencies.end());
+    }
+
+    // Sleeps until the next period of the bench thread, counting overruns.
+    void wait_next(std::chrono::steady_clock::time_point &next, std::chrono::steady_clock::duration period,
+                   StepResult &result)
+    {
+        next += period;
+        auto now = std::chrono::steady_clock::now();
+        if (next < now)
+        {
+            ++result.overruns;
+            next = now;
+        }
+        std::this_thread::sleep_until(next);
+    }
+
+    StepResult run_direct_step(int32_t first_id, size_t motors, float rate_hz, double seconds)
+    {
+        std::vector<int32_t> ids = motor_ids(first_id, motors);
+        FourierMotorManager manager(ids);
+        manager.wait_for_first_messages(1.0);
+
+        StepResult result;
+        result.motors = motors;
+        result.rate_hz = rate_hz;
+
+        std::vector<MotorFeedback> feedback;
+        std::vector<double> last_arrival(motors, 0.0);
+        std::vector<double> latencies;
+        latencies.reserve(size_t(seconds * rate_hz * motors));
+        uint64_t ticks = 0;
+        uint64_t frames = 0;
+
+        auto period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(1.0 / rate_hz));
+        double cpu_start = cpu_seconds();
+        double start = monotonic_seconds();
+        auto next = std::chrono::steady_clock::now();
+        while (monotonic_seconds() - start < seconds)
+        {
+            manager.read_feedback(feedback);
+            for (size_t i = 0; i < motors; ++i)
+            {
+                if (!feedback[i].valid)
+                {
+                    ++result.drops;
+                    continue;
+                }
+                double read_time = monotonic_seconds();
+                double age = 0.0;
+                if (parse_motor_age(manager.get_motor_state(ids[i]), age))
+                {
+                    double arrival = read_time - age;
+                    if (arrival - last_arrival[i] > 100e-6)
+                        ++frames;
+                    last_arrival[i] = arrival;
+                }
+
+                double before = monotonic_seconds();
+                bool ok = manager.set_position(ids[i], feedback[i].position);
+                latencies.push_back(monotonic_seconds() - before);
+                if (!ok)
+                    ++result.drops;
+            }
+            ++ticks;
+            wait_next(next, period, result);
+        }
+        double elapsed = monotonic_seconds() - start;
+
+        result.achieved_hz = double(ticks) / elapsed;
+        result.feedback_hz = double(frames) / elapsed / double(motors);
+        finish_latencies(result, latencies);
+        result.cpu_percent = 100.0 * (cpu_seconds() - cpu_start) / elapsed;
+        return result;
+    }
+
+    // The worker ticks at `rate_hz`; the bench thread runs at the same rate,
+    // reads the latest snapshot and stages one position per motor. Setter
+    // latency is the staging cost; queue latency runs to the bridge call.
+    StepResult run_worker_step(int32_t first_id, size_t motors, float rate_hz, double seconds)
+    {
+        std::vector<int32_t> ids = motor_ids(first_id, motors);
+        FourierMotorManager manager(ids);
+        manager.wait_for_first_messages(1.0);
+        manager.enable_clock_sync(64);
+
+        std::atomic<uint64_t> frames(0);
+        manager.set_tick_callback([&frames](const std::vector<MotorFeedback> &feedback)
+                                  {
+                                      uint64_t fresh = 0;
+                                      for (const auto &motor : feedback)
+                                          fresh += motor.fresh ? 1 : 0;
+                                      frames.fetch_add(fresh, std::memory_order_relaxed); });
+
+        StepResult result;
+        result.motors = motors;
+        result.rate_hz = rate_hz;
+
+        std::vector<double> latencies;
+        latencies.reserve(size_t(seconds * rate_hz * motors));
+        FeedbackSnapshot snapshot;
+
+        auto period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(1.0 / rate_hz));
+        double cpu_start = cpu_seconds();
+        if (!manager.start(rate_hz))
+            return result;
+        double start = monotonic_seconds();
+        auto next = std::chrono::steady_clock::now();
+        while (monotonic_seconds() - start < seconds)
+        {
+            if (manager.snapshot(snapshot))
+            {
+                for (const auto &motor : snapshot.motors)
+                {
+                    if (!motor.valid)
+                    {
+                        ++result.drops;
+                        continue;
+                    }
+                    double before = monotonic_seconds();
+                    bool ok = manager.set_position(motor.id, motor.position);
+                    latencies.push_back(monotonic_seconds() - before);
+                    if (!ok)
+                        ++result.drops;
+                }
+            }
+            wait_next(next, period, result);
+        }
+        double elapsed = monotonic_seconds() - start;
+        manager.stop();
+
+        IoStats io = manager.io_stats();
+        QueueStats queue = manager.queue_stats();
+        LatencyStats latency = manager.latency_stats();
+        result.achieved_hz = double(io.ticks) / elapsed;
+        result.feedback_hz = double(frames.load()) / elapsed / double(motors);
+        finish_latencies(result, latencies);
+        result.cpu_percent = 100.0 * (cpu_seconds() - cpu_start) / elapsed;
+        result.calls_per_tick = io.ticks ? double(io.bridge_calls) / double(io.ticks) : 0.0;
+        result.max_tick_calls = io.max_tick_calls;
+        result.coalesced = queue.dropped_oldest;
+        result.drops += queue.dropped_newest + queue.timeouts;
+        result.queue_mean_us = 1e6 * queue.latency_mean;
+        result.queue_max_us = 1e6 * queue.latency_max;
+        result.wakeup_mean_us = 1e6 * latency.wakeup_mean;
+        result.wakeup_max_us = 1e6 * latency.wakeup_max;
+        result.age_max_us = 1e6 * latency.age_max;
+        return result;
+    }
+
+    void print_header(bool worker)
+    {
+        std::printf("%7s %7s %11s %11s %9s %9s %9s %9s %7s %6s",
+                    "motors", "rate", "achieved", "fb_hz/mot", "p50_us", "p99_us", "max_us", "overruns", "drops", "cpu%");
+        if (worker)
+            std::printf(" %10s %10s %9s %9s %9s %9s %9s %9s",
+                        "calls/tick", "max_calls", "coalesced", "q_mean_us", "q_max_us", "wk_mean", "wk_max", "age_max");
+        std::printf("\n");
+    }
+
+    void print_row(const StepResult &r, bool worker)
+    {
+        std::printf("%7zu %7.0f %11.1f %11.1f %9.1f %9.1f %9.1f %9llu %7llu %6.1f",
+                    r.motors, r.rate_hz, r.achieved_hz, r.feedback_hz, r.p50_us, r.p99_us, r.max_us,
+                    (unsigned long long)r.overruns, (unsigned long long)r.drops, r.cpu_percent);
+        if (worker)
+            std::printf(" %10.1f %10llu %9llu %9.1f %9.1f %9.1f %9.1f %9.1f",
+                        r.calls_per_tick, (unsigned long long)r.max_tick_calls, (unsigned long long)r.coalesced,
+                        r.queue_mean_us, r.queue_max_us, r.wakeup_mean_us, r.wakeup_max_us, r.age_max_us);
+        std::printf("\n");
+        std::fflush(stdout);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    int32_t first_id = argc > 1 ? int32_t(std::atoi(argv[1])) : 1;
+    double seconds = argc > 2 ? std::atof(argv[2]) : 5.0;
+    const char *mode = argc > 3 ? argv[3] : "both";
+    bool direct = std::strcmp(mode, "worker") != 0;
+    bool worker = std::strcmp(mode, "direct") != 0;
+
+    const size_t motor_counts[] = {10, 25, 50, 100, 150, 200};
+    const float rates[] = {500.0f, 1000.0f, 2000.0f};
+
+    if (direct)
+    {
+        std::printf("direct bridge calls\n");
+        print_header(false);
+        for (size_t motors : motor_counts)
+            for (float rate : rates)
+                print_row(run_direct_step(first_id, motors, rate, seconds), false);
+    }
+    if (worker)
+    {
+        std::printf("%sI/O worker\n", direct ? "\n" : "");
+        print_header(true);
+        for (size_t motors : motor_counts)
+            for (float rate : rates)
+                print_row(run_worker_step(first_id, motors, rate, seconds), true);
+    }
+}